@@ -0,0 +1,216 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memAccount.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the overhead accounting. Each live block counts
+* its size as user bytes, its padding as canary bytes, its header as
+* metadata, and whatever its allocation holds beyond those as slack: the
+* usable size from the system allocator, or the slot stride of an arena.
+* A free'd block still held counts in full as quarantine. Running totals
+* are kept as blocks are allocated, resized, free'd and released, so a
+* report does not walk the records. The record arrays, the site, thread
+* and capture tables and the arena side tables are added to the metadata,
+* and committed arena slots holding no block to the slack.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Running totals, static tables counted as metadata. JME
+*************************************************************************/
+#include "memAccount.h"
+#include "memPlatform.h"
+#include "memStore.h"
+#include "memArena.h"
+#include "memProfile.h"
+#include "memThread.h"
+#include "memWatch.h"
+
+// Only compiled at the sampled and full tracking levels.
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Overhead of every block, header and padding.
+#define BLOCK_OVERHEAD (MALLOC_HEADER + MALLOC_PADDING)
+
+// Live blocks of one size class.
+typedef struct SIZECLASS {
+	uint64_t blocks;     // Number of blocks.
+	uint64_t userBytes;  // Requested bytes.
+	uint64_t slackBytes; // Allocated beyond size, header and padding.
+} sizeclass;
+
+// Running totals of the counted blocks.
+static memoverhead totals;
+static sizeclass classes[ACCOUNT_CLASSES];
+#ifdef MEMTRACK_ARENA
+static size_t arenaBlocks = 0; // Footprint of blocks held in arena slots.
+#endif
+
+// Bytes allocated for a block, header and padding included.
+static size_t blockFootprint(uint8_t *pMem, size_t size)
+{
+	size_t usable;
+
+#ifdef MEMTRACK_ARENA
+	// The whole slot.
+	if (arenaContains(pMem))
+		return arenaCapacity(pMem) + MALLOC_USER_OFFSET + MALLOC_PADDING_LENGTH;
+#endif
+
+	usable = allocationSize(pMem - MALLOC_USER_OFFSET);
+
+	return (usable > size + BLOCK_OVERHEAD) ? usable : size + BLOCK_OVERHEAD;
+}
+
+// Size class of a block.
+static uint32_t blockClass(size_t size)
+{
+	uint32_t c = 0;
+
+	while (c < ACCOUNT_CLASSES - 1 && size + BLOCK_OVERHEAD > ((size_t)1 << (ACCOUNT_MIN_SHIFT + c)))
+		c++;
+
+	return c;
+}
+
+// Add (or take away) the block of a record to the totals, as live or as
+// free'd.
+static void accountBlock(uint32_t index, bool freed, bool add)
+{
+	uint8_t *pMem = blocks.pMem[index];
+	size_t size = storeSize(index);
+	size_t footprint = blockFootprint(pMem, size);
+	size_t slack = footprint - size - BLOCK_OVERHEAD;
+	sizeclass *psc;
+
+#ifdef MEMTRACK_ARENA
+	if (arenaContains(pMem))
+		arenaBlocks = add ? arenaBlocks + footprint : arenaBlocks - footprint;
+#endif
+
+	// Free'd blocks are held whole until released.
+	if (freed)
+	{
+		totals.quarantineBytes = add ? totals.quarantineBytes + footprint : totals.quarantineBytes - footprint;
+		return;
+	}
+
+	psc = &classes[blockClass(size)];
+	if (add)
+	{
+		totals.userBytes += size;
+		totals.canaryBytes += MALLOC_PADDING;
+		totals.metadataBytes += MALLOC_HEADER;
+		totals.slackBytes += slack;
+		psc->blocks++;
+		psc->userBytes += size;
+		psc->slackBytes += slack;
+	}
+	else
+	{
+		totals.userBytes -= size;
+		totals.canaryBytes -= MALLOC_PADDING;
+		totals.metadataBytes -= MALLOC_HEADER;
+		totals.slackBytes -= slack;
+		psc->blocks--;
+		psc->userBytes -= size;
+		psc->slackBytes -= slack;
+	}
+}
+
+// Count the block of a record, once it has its memory.
+void accountAdd(uint32_t index)
+{
+	accountBlock(index, CHECK_BLOCK_FREE(blocks.tag[index]), true);
+}
+
+// Stop counting the block of a record, before it is resized or released.
+void accountRemove(uint32_t index)
+{
+	accountBlock(index, CHECK_BLOCK_FREE(blocks.tag[index]), false);
+}
+
+// Move a live block to quarantine as it is free'd.
+void accountFreed(uint32_t index)
+{
+	accountBlock(index, false, false);
+	accountBlock(index, true, true);
+}
+
+// Return the breakdown of memory behind the tracked blocks.
+void accountMemory(memoverhead *pOverhead)
+{
+	*pOverhead = totals;
+
+	// Records, and the fixed site, thread and capture tables.
+	pOverhead->metadataBytes += storeBytes() + profileBytes() + threadBytes() + watermarkBytes();
+
+#ifdef MEMTRACK_ARENA
+	{
+		size_t slotBytes, indexBytes;
+
+		// Committed slots holding no block.
+		arenaUsage(&slotBytes, &indexBytes);
+		pOverhead->metadataBytes += indexBytes;
+		pOverhead->slackBytes += slotBytes - arenaBlocks;
+	}
+#endif
+}
+
+// Append the breakdown and internal fragmentation per size class.
+void streamOverhead(memstream *ms)
+{
+	memoverhead overhead;
+
+	accountMemory(&overhead);
+
+	streamPuts(ms, "Memory user: ");
+	streamUnsigned(ms, overhead.userBytes);
+	streamPuts(ms, " canary: ");
+	streamUnsigned(ms, overhead.canaryBytes);
+	streamPuts(ms, " metadata: ");
+	streamUnsigned(ms, overhead.metadataBytes);
+	streamPuts(ms, " quarantine: ");
+	streamUnsigned(ms, overhead.quarantineBytes);
+	streamPuts(ms, " slack: ");
+	streamUnsigned(ms, overhead.slackBytes);
+	streamPuts(ms, " bytes\n");
+
+	// Only classes holding live blocks.
+	for (uint32_t c = 0; c < ACCOUNT_CLASSES; c++)
+	{
+		const sizeclass *psc = &classes[c];
+		uint64_t footprint = psc->userBytes + psc->blocks * BLOCK_OVERHEAD + psc->slackBytes;
+
+		if (psc->blocks == 0)
+			continue;
+
+		if (c < ACCOUNT_CLASSES - 1)
+		{
+			streamPuts(ms, "<=");
+			streamUnsigned(ms, (uint64_t)1 << (ACCOUNT_MIN_SHIFT + c));
+		}
+		else
+		{
+			streamPuts(ms, ">");
+			streamUnsigned(ms, (uint64_t)1 << (ACCOUNT_MIN_SHIFT + c - 1));
+		}
+		streamPuts(ms, " blocks: ");
+		streamUnsigned(ms, psc->blocks);
+		streamPuts(ms, " user: ");
+		streamUnsigned(ms, psc->userBytes);
+		streamPuts(ms, " slack: ");
+		streamUnsigned(ms, psc->slackBytes);
+		streamPuts(ms, " (");
+		streamUnsigned(ms, psc->slackBytes * 100 / footprint);
+		streamPuts(ms, "%)\n");
+	}
+}
+
+#endif
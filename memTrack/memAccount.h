@@ -0,0 +1,46 @@
+/*************************************************************************
+* Title: memTracker
+* File: memAccount.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the overhead accounting of memTracker. The memory
+* behind the tracked blocks is broken down into user bytes, canary
+* (padding) bytes, metadata, free'd blocks not yet released, and slack
+* left by the allocator's rounding, with internal fragmentation reported
+* per power of 2 size class.
+*
+* Notes:
+*  (1) All functions must be called with the tracker lock held. The
+*      totals are updated as blocks change, a report reads them.
+*  (2) Allocator slack needs the usable size of a block (see
+*      allocationSize() in memPlatform.h), it reads 0 where unknown.
+*  (3) Only compiled at the sampled and full tracking levels.
+*  (4) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added accountAdd(), accountRemove() and accountFreed(). JME
+*************************************************************************/
+#ifndef _MEM_ACCOUNT_H_
+#define _MEM_ACCOUNT_H_
+
+#include "memTrack.h"
+#include "memStream.h"
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Size classes, powers of 2 from 32 bytes by the footprint a block needs
+// (size, header and padding). The last class holds all larger blocks.
+#define ACCOUNT_MIN_SHIFT 5
+#define ACCOUNT_CLASSES   16
+
+void accountAdd(uint32_t);
+void accountRemove(uint32_t);
+void accountFreed(uint32_t);
+void accountMemory(memoverhead *);
+void streamOverhead(memstream *);
+
+#endif
+
+#endif
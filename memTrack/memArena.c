@@ -0,0 +1,299 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memArena.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the size-class arenas. One address range is
+* reserved for all classes, each class taking 1 << MEMTRACK_ARENA_SHIFT
+* bytes of it, and memory is committed as the class grows. A slot is laid
+* out as [header][padding][memory][padding to end of slot], the padding
+* painted like any tracked block. Freed slots wait in a per-class
+* quarantine, and are checked for access after free as they leave it. A
+* released slot is painted dead throughout and checked again when reused.
+* The header word of a reusable slot links it to the next one.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled when MEMTRACK_ARENA is defined (see memLevel.h).
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Side table holds record indexes, quarantine is a ring. JME
+*   10/19/2026: Added arenaUsage(). JME
+*   10/19/2026: Class table counted in arenaUsage(). JME
+*   10/19/2026: Released slots checked again when reused. JME
+*************************************************************************/
+#include "memArena.h"
+#include "memPlatform.h"
+#include "memAccount.h"
+
+// Only compiled when the arena backend is enabled.
+#ifdef MEMTRACK_ARENA
+
+// Memory is committed in steps of this many bytes (a multiple of the page size).
+#define ARENA_COMMIT_BYTES (64 * 1024)
+
+// Bytes reserved per class.
+#define ARENA_CLASS_BYTES ((size_t)1 << MEMTRACK_ARENA_SHIFT)
+
+// Quarantine ring length (one spare entry).
+#define ARENA_RING (MEMTRACK_ARENA_QUARANTINE + 1)
+
+// State of one size class.
+typedef struct ARENACLASS {
+	uint8_t *pSlots;              // First slot.
+	uint32_t *pIndex;             // Side table, record index of each slot (BLOCK_NONE if unused).
+	uint32_t shift;               // Slot stride (log2 bytes).
+	size_t used;                  // Slots handed out at least once.
+	size_t committed;             // Slots backed by committed memory.
+	size_t indexCommitted;        // Side table bytes committed.
+	uint32_t freeHead;            // First reusable slot (BLOCK_NONE if none).
+	uint32_t quarantine[ARENA_RING]; // Quarantined slots, oldest at quarantineHead.
+	size_t quarantineHead;
+	size_t quarantined;
+} arenaclass;
+
+static arenaclass arenaClasses[ARENA_CLASSES];
+static uint8_t *arenaBase = NULL;  // Start of the reserved range.
+static bool arenaFailed = false;   // Reservation failed or released, never retried.
+
+// Side table bytes reserved for a class.
+static size_t arenaIndexBytes(const arenaclass *pac)
+{
+	return (ARENA_CLASS_BYTES >> pac->shift) * sizeof(uint32_t);
+}
+
+// Reserve the arena and side tables on first use.
+static bool arenaCreate(void)
+{
+	if (arenaBase != NULL)
+		return true;
+	if (arenaFailed)
+		return false;
+
+	arenaBase = (uint8_t *)memoryReserve(ARENA_CLASSES * ARENA_CLASS_BYTES);
+	arenaFailed = (bool)(arenaBase == NULL);
+
+	for (uint32_t c = 0; c < ARENA_CLASSES && !arenaFailed; c++)
+	{
+		arenaclass *pac = &arenaClasses[c];
+
+		pac->pSlots = arenaBase + c * ARENA_CLASS_BYTES;
+		pac->shift = ARENA_MIN_SHIFT + c;
+		pac->freeHead = BLOCK_NONE;
+		pac->pIndex = (uint32_t *)memoryReserve(arenaIndexBytes(pac));
+		arenaFailed = (bool)(pac->pIndex == NULL);
+	}
+
+	if (arenaFailed)
+		arenaDestroy();
+
+	return !arenaFailed;
+}
+
+// Commit the next step of a class, and the side table entries for it.
+static bool arenaGrow(arenaclass *pac)
+{
+	size_t slots = ARENA_COMMIT_BYTES >> pac->shift;
+	size_t indexNeeded = (pac->committed + slots) * sizeof(uint32_t);
+
+	if (pac->committed + slots > (ARENA_CLASS_BYTES >> pac->shift))
+		return false;
+
+	if (!memoryCommit(pac->pSlots + (pac->committed << pac->shift), ARENA_COMMIT_BYTES))
+		return false;
+
+	if (indexNeeded > pac->indexCommitted)
+	{
+		size_t step = (indexNeeded - pac->indexCommitted + ARENA_COMMIT_BYTES - 1) / ARENA_COMMIT_BYTES * ARENA_COMMIT_BYTES;
+
+		if (pac->indexCommitted + step > arenaIndexBytes(pac))
+			step = arenaIndexBytes(pac) - pac->indexCommitted;
+		if (!memoryCommit((uint8_t *)pac->pIndex + pac->indexCommitted, step))
+			return false;
+		pac->indexCommitted += step;
+	}
+
+	pac->committed += slots;
+
+	return true;
+}
+
+// Class of an arena address.
+static arenaclass *arenaClassOf(const uint8_t *p)
+{
+	return &arenaClasses[((uintptr_t)p - (uintptr_t)arenaBase) >> MEMTRACK_ARENA_SHIFT];
+}
+
+// Slot number of an arena address within its class.
+static uint32_t arenaSlotOf(const arenaclass *pac, const uint8_t *p)
+{
+	return (uint32_t)((size_t)(p - pac->pSlots) >> pac->shift);
+}
+
+// Start (header word) of a slot.
+static uint8_t *arenaSlot(const arenaclass *pac, uint32_t slot)
+{
+	return pac->pSlots + ((size_t)slot << pac->shift);
+}
+
+// Bytes of a slot after its header word.
+static size_t arenaLength(const arenaclass *pac)
+{
+	return ((size_t)1 << pac->shift) - MALLOC_HEADER;
+}
+
+// Check a freed slot is still painted as freed: size bytes from offset
+// first (after the header word) dead, the rest clean.
+static void arenaCheck(const arenaclass *pac, uint32_t slot, size_t first, size_t size)
+{
+	uint8_t *pPad = arenaSlot(pac, slot) + MALLOC_HEADER;
+	size_t length = arenaLength(pac);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		bool user = (bool)(i >= first && i < first + size);
+
+		if (pPad[i] != (user ? _deadLandFill : _cleanLandFill))
+		{
+			fprintf(stderr, "*** WARNING: Free'd memory access detected at 0x%p.\n", pPad + i);
+			return;
+		}
+	}
+}
+
+// True if the pointer lies within the arena. Safe without the lock.
+bool arenaContains(const void *pMem)
+{
+	return (bool)(arenaBase != NULL && (uintptr_t)pMem - (uintptr_t)arenaBase < ARENA_CLASSES * ARENA_CLASS_BYTES);
+}
+
+// Allocate and paint a slot for size bytes, owned by a record. Returns the
+// user memory, or NULL if too large or the class is full.
+uint8_t *arenaAllocate(size_t size, uint32_t index)
+{
+	arenaclass *pac;
+	uint32_t slot;
+	uint32_t c = 0;
+
+	if (size > ARENA_MAX_SIZE || !arenaCreate())
+		return NULL;
+
+	// Smallest class with room for the header and padding.
+	while (size + MALLOC_USER_OFFSET + MALLOC_PADDING_LENGTH > ((size_t)1 << (ARENA_MIN_SHIFT + c)))
+		c++;
+	pac = &arenaClasses[c];
+
+	// Reuse a slot, else take the next unused one.
+	if (pac->freeHead != BLOCK_NONE)
+	{
+		slot = pac->freeHead;
+		pac->freeHead = HEADER_INDEX(*(uint64_t *)arenaSlot(pac, slot));
+
+		// Catch a write made after the slot left quarantine.
+		arenaCheck(pac, slot, 0, arenaLength(pac));
+	}
+	else
+	{
+		if (pac->used == pac->committed && !arenaGrow(pac))
+			return NULL;
+		slot = (uint32_t)pac->used++;
+	}
+
+	pac->pIndex[slot] = index;
+
+	// Paint the whole slot, padding included, as uninitialized.
+	memset(arenaSlot(pac, slot) + MALLOC_HEADER, _cleanLandFill, arenaLength(pac));
+
+	return arenaSlot(pac, slot) + MALLOC_USER_OFFSET;
+}
+
+// Quarantine a freed block (already painted dead), releasing the oldest
+// quarantined slot of its class, and its record, for reuse.
+void arenaFree(const uint8_t *pMem)
+{
+	arenaclass *pac = arenaClassOf(pMem);
+
+	pac->quarantine[(pac->quarantineHead + pac->quarantined++) % ARENA_RING] = arenaSlotOf(pac, pMem);
+
+	if (pac->quarantined > MEMTRACK_ARENA_QUARANTINE)
+	{
+		uint32_t slot = pac->quarantine[pac->quarantineHead];
+		uint32_t index = pac->pIndex[slot];
+
+		pac->quarantineHead = (pac->quarantineHead + 1) % ARENA_RING;
+		pac->quarantined--;
+
+		arenaCheck(pac, slot, MALLOC_START_OFFSET, storeSize(index));
+		accountRemove(index);
+		storeRelease(index);
+
+		// Paint the whole slot dead, so it can be checked again when reused
+		// without its record.
+		memset(arenaSlot(pac, slot) + MALLOC_HEADER, _deadLandFill, arenaLength(pac));
+
+		// The header links the slot into the reusable list, still marked
+		// as tracked so a late free is caught.
+		pac->pIndex[slot] = BLOCK_NONE;
+		*(uint64_t *)arenaSlot(pac, slot) = HEADER_RECORD(pac->freeHead);
+		pac->freeHead = slot;
+	}
+}
+
+// Return the record of the block containing the pointer, BLOCK_NONE if the
+// slot is unused or the pointer is not within the block.
+uint32_t arenaRecord(const uint8_t *pMem)
+{
+	arenaclass *pac = arenaClassOf(pMem);
+	uint32_t slot = arenaSlotOf(pac, pMem);
+	uint32_t index;
+
+	if (slot >= pac->used || (index = pac->pIndex[slot]) == BLOCK_NONE)
+		return BLOCK_NONE;
+	if ((uintptr_t)pMem - (uintptr_t)blocks.pMem[index] >= storeSize(index))
+		return BLOCK_NONE;
+
+	return index;
+}
+
+// Largest size the slot of a block can hold.
+size_t arenaCapacity(const uint8_t *pMem)
+{
+	return ((size_t)1 << arenaClassOf(pMem)->shift) - MALLOC_USER_OFFSET - MALLOC_PADDING_LENGTH;
+}
+
+// Return bytes committed to slots and to side tables.
+void arenaUsage(size_t *pSlotBytes, size_t *pIndexBytes)
+{
+	*pSlotBytes = 0;
+	*pIndexBytes = sizeof(arenaClasses);
+
+	for (uint32_t c = 0; c < ARENA_CLASSES; c++)
+	{
+		*pSlotBytes += arenaClasses[c].committed << arenaClasses[c].shift;
+		*pIndexBytes += arenaClasses[c].indexCommitted;
+	}
+}
+
+// Release the arena and side tables.
+void arenaDestroy(void)
+{
+	for (uint32_t c = 0; c < ARENA_CLASSES; c++)
+	{
+		arenaclass *pac = &arenaClasses[c];
+
+		if (pac->pIndex != NULL)
+			memoryRelease(pac->pIndex, arenaIndexBytes(pac));
+		memset(pac, 0, sizeof(arenaclass));
+	}
+
+	if (arenaBase != NULL)
+		memoryRelease(arenaBase, ARENA_CLASSES * ARENA_CLASS_BYTES);
+	arenaBase = NULL;
+	arenaFailed = true;
+}
+
+#endif
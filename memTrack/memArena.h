@@ -0,0 +1,61 @@
+/*************************************************************************
+* Title: memTracker
+* File: memArena.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the optional size-class arena backend of memTracker.
+* Small tracked blocks are carved from one reserved region per size class
+* and their record indexes kept in a side table indexed by slot number, so
+* finding the record for a pointer is a subtract, shift and mask.
+*
+* Notes:
+*  (1) Define MEMTRACK_ARENA project wide to enable (see memLevel.h).
+*  (2) All functions, except arenaContains(), must be called with the
+*      tracker lock held.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Side table holds record indexes (see memStore.h). JME
+*   10/19/2026: Added arenaUsage(). JME
+*************************************************************************/
+#ifndef _MEM_ARENA_H_
+#define _MEM_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memTrack.h"
+#include "memStore.h"
+
+#ifdef MEMTRACK_ARENA
+
+// Address space reserved per size class (log2 bytes). A class which fills
+// its region falls back to the system allocator.
+#ifndef MEMTRACK_ARENA_SHIFT
+#define MEMTRACK_ARENA_SHIFT 24
+#endif
+
+// Freed slots of a class are held this many frees before reuse.
+#ifndef MEMTRACK_ARENA_QUARANTINE
+#define MEMTRACK_ARENA_QUARANTINE 64
+#endif
+
+// Size classes, slot strides are powers of 2 from 32 to 4096 bytes. Every
+// slot holds the header and padding around the user memory.
+#define ARENA_MIN_SHIFT 5
+#define ARENA_CLASSES   8
+#define ARENA_MAX_SIZE  ((1u << (ARENA_MIN_SHIFT + ARENA_CLASSES - 1)) - MALLOC_USER_OFFSET - MALLOC_PADDING_LENGTH)
+
+bool arenaContains(const void *);
+uint8_t *arenaAllocate(size_t, uint32_t);
+void arenaFree(const uint8_t *);
+uint32_t arenaRecord(const uint8_t *);
+size_t arenaCapacity(const uint8_t *);
+void arenaUsage(size_t *, size_t *);
+void arenaDestroy(void);
+
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+/*************************************************************************
+* Title: memTracker
+* File: memLevel.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file selects the memTracker tracking level. Each level compiles in
+* only the code it needs, so the counters level may be left in optimized
+* release builds.
+*
+* Notes:
+*  (1) Define MEMTRACK_LEVEL project wide (e.g. /DMEMTRACK_LEVEL=1), the
+*      tracker and your program must agree on the level.
+*  (2) Defaults to MEMTRACK_FULL in debug builds, MEMTRACK_OFF otherwise.
+*  (3) Define MEMTRACK_ARENA to serve small tracked blocks from the
+*      size-class arenas (see memArena.h) instead of the system allocator.
+*  (4) Included by memTracker.h, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added MEMTRACK_ARENA. JME
+*************************************************************************/
+#ifndef _MEM_LEVEL_H_
+#define _MEM_LEVEL_H_
+
+// Tracking levels.
+#define MEMTRACK_OFF      0 // No tracking, plain system calls.
+#define MEMTRACK_COUNTERS 1 // Allocation/free counts, live and peak bytes.
+#define MEMTRACK_SAMPLED  2 // Counters, plus full tracking of sampled allocations.
+#define MEMTRACK_FULL     3 // Every allocation painted, checked and profiled.
+
+#ifndef MEMTRACK_LEVEL
+#ifdef _DEBUG
+#define MEMTRACK_LEVEL MEMTRACK_FULL
+#else
+#define MEMTRACK_LEVEL MEMTRACK_OFF
+#endif
+#endif
+
+// At the sampled level, 1 in this many allocations is fully tracked.
+#ifndef MEMTRACK_SAMPLE_RATE
+#define MEMTRACK_SAMPLE_RATE 64
+#endif
+
+// The arenas only hold tracked blocks.
+#if defined(MEMTRACK_ARENA) && MEMTRACK_LEVEL < MEMTRACK_SAMPLED
+#undef MEMTRACK_ARENA
+#endif
+
+#endif
@@ -0,0 +1,454 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memPlatform.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the operating system layer declared in
+* memPlatform.h, keeping platform conditionals out of the tracking code.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Not compiled when tracking is off.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added virtual memory reserve/commit/release. JME
+*   10/19/2026: Added processorCount(), semaphoreDestroy(). JME
+*   10/19/2026: Added allocationSize(). JME
+*   10/19/2026: Signal handlers keep and restore the previous handler. JME
+*   10/19/2026: Added semaphoreWaitFor(), optional coarse clock. JME
+*************************************************************************/
+// POSIX and BSD extensions (sigaction flags, anonymous mappings, syscall).
+#ifndef _WIN32
+#define _GNU_SOURCE
+#define _DEFAULT_SOURCE
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "memPlatform.h"
+
+// Nothing is compiled when tracking is off.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// Entry point and argument handed through the operating system thread call.
+typedef struct THREADSTART {
+	memthreadentry entry;
+	void *arg;
+} threadstart;
+
+// Most signals given handlers by signalInstall().
+#define MEM_SIGNALS 4
+
+// Signals given handlers, 0 if unused.
+static int signalNumbers[MEM_SIGNALS];
+
+#ifdef _WIN32
+
+#include <io.h>
+#include <malloc.h>
+
+void lockAcquire(memlock *pLock)
+{
+	AcquireSRWLockExclusive(pLock);
+}
+
+void lockRelease(memlock *pLock)
+{
+	ReleaseSRWLockExclusive(pLock);
+}
+
+bool semaphoreCreate(memsemaphore *pSem)
+{
+	*pSem = CreateSemaphore(NULL, 0, LONG_MAX, NULL);
+	return (bool)(*pSem != NULL);
+}
+
+void semaphorePost(memsemaphore *pSem)
+{
+	ReleaseSemaphore(*pSem, 1, NULL);
+}
+
+void semaphoreWait(memsemaphore *pSem)
+{
+	WaitForSingleObject(*pSem, INFINITE);
+}
+
+bool semaphoreWaitFor(memsemaphore *pSem, uint64_t nanoseconds)
+{
+	uint64_t ms = nanoseconds / 1000000;
+
+	return (bool)(WaitForSingleObject(*pSem, ms < INFINITE ? (DWORD)ms : INFINITE - 1) == WAIT_OBJECT_0);
+}
+
+void semaphoreDestroy(memsemaphore *pSem)
+{
+	CloseHandle(*pSem);
+}
+
+static DWORD WINAPI threadTrampoline(LPVOID param)
+{
+	threadstart ts = *(threadstart *)param;
+
+	free(param);
+	ts.entry(ts.arg);
+
+	return 0;
+}
+
+bool threadStart(memthreadentry entry, void *arg)
+{
+	threadstart *pts = (threadstart *)malloc(sizeof(threadstart));
+	HANDLE hThread;
+
+	if (pts == NULL)
+		return false;
+	pts->entry = entry;
+	pts->arg = arg;
+
+	hThread = CreateThread(NULL, 0, threadTrampoline, pts, 0, NULL);
+	if (hThread == NULL)
+	{
+		free(pts);
+		return false;
+	}
+
+	// Detach.
+	CloseHandle(hThread);
+
+	return true;
+}
+
+uint64_t threadIdentifier(void)
+{
+	return (uint64_t)GetCurrentThreadId();
+}
+
+unsigned int processorCount(void)
+{
+	SYSTEM_INFO si;
+
+	GetSystemInfo(&si);
+
+	return si.dwNumberOfProcessors ? (unsigned int)si.dwNumberOfProcessors : 1;
+}
+
+size_t allocationSize(void *p)
+{
+	return _msize(p);
+}
+
+// Handlers in place before signalInstall().
+static void (*signalPrevious[MEM_SIGNALS])(int);
+
+bool signalInstall(int sig, void (*handler)(int), bool replace)
+{
+	void (*previous)(int) = signal(sig, handler);
+
+	// Windows has no query, so a handler the program installed is put back.
+	if (previous == SIG_ERR || (!replace && previous != SIG_DFL))
+	{
+		if (previous != SIG_ERR)
+			signal(sig, previous);
+		return false;
+	}
+
+	for (int i = 0; i < MEM_SIGNALS; i++)
+		if (signalNumbers[i] == 0 || signalNumbers[i] == sig)
+		{
+			signalNumbers[i] = sig;
+			signalPrevious[i] = previous;
+			break;
+		}
+
+	return true;
+}
+
+void signalRestore(int sig)
+{
+	void (*previous)(int) = SIG_DFL;
+
+	for (int i = 0; i < MEM_SIGNALS; i++)
+		if (signalNumbers[i] == sig)
+			previous = signalPrevious[i];
+	signal(sig, previous);
+}
+
+void writeDescriptor(int fd, const void *pBuf, size_t length)
+{
+	const char *p = (const char *)pBuf;
+
+	while (length > 0)
+	{
+		int n = _write(fd, p, (unsigned int)(length > INT_MAX ? INT_MAX : length));
+
+		if (n <= 0)
+			return;
+		p += n;
+		length -= (size_t)n;
+	}
+}
+
+// The performance counter reads the TSC on current hardware. The tick count
+// is cheaper, but only ticks every 10 to 16 ms.
+uint64_t clockNanoseconds(void)
+{
+#ifdef MEMTRACK_COARSE_CLOCK
+	return (uint64_t)GetTickCount64() * 1000000u;
+#else
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+
+	// Split to avoid overflowing the multiply.
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000u
+		+ (uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000u / (uint64_t)frequency.QuadPart;
+#endif
+}
+
+void *memoryReserve(size_t length)
+{
+	return VirtualAlloc(NULL, length, MEM_RESERVE, PAGE_NOACCESS);
+}
+
+bool memoryCommit(void *p, size_t length)
+{
+	return (bool)(VirtualAlloc(p, length, MEM_COMMIT, PAGE_READWRITE) != NULL);
+}
+
+void memoryRelease(void *p, size_t length)
+{
+	(void)length;
+	VirtualFree(p, 0, MEM_RELEASE);
+}
+
+#else
+
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#endif
+
+void lockAcquire(memlock *pLock)
+{
+	pthread_mutex_lock(pLock);
+}
+
+void lockRelease(memlock *pLock)
+{
+	pthread_mutex_unlock(pLock);
+}
+
+bool semaphoreCreate(memsemaphore *pSem)
+{
+	return (bool)(sem_init(pSem, 0, 0) == 0);
+}
+
+void semaphorePost(memsemaphore *pSem)
+{
+	sem_post(pSem);
+}
+
+void semaphoreWait(memsemaphore *pSem)
+{
+	// Retry if interrupted by a signal.
+	while (sem_wait(pSem) != 0 && errno == EINTR);
+}
+
+bool semaphoreWaitFor(memsemaphore *pSem, uint64_t nanoseconds)
+{
+	struct timespec ts;
+
+	// The deadline is on the realtime clock.
+	clock_gettime(CLOCK_REALTIME, &ts);
+	ts.tv_sec += (time_t)(nanoseconds / 1000000000u);
+	ts.tv_nsec += (long)(nanoseconds % 1000000000u);
+	if (ts.tv_nsec >= 1000000000)
+	{
+		ts.tv_sec++;
+		ts.tv_nsec -= 1000000000;
+	}
+
+	// Retry if interrupted by a signal.
+	while (sem_timedwait(pSem, &ts) != 0)
+		if (errno != EINTR)
+			return false;
+
+	return true;
+}
+
+void semaphoreDestroy(memsemaphore *pSem)
+{
+	sem_destroy(pSem);
+}
+
+static void *threadTrampoline(void *param)
+{
+	threadstart ts = *(threadstart *)param;
+
+	free(param);
+	ts.entry(ts.arg);
+
+	return NULL;
+}
+
+bool threadStart(memthreadentry entry, void *arg)
+{
+	threadstart *pts = (threadstart *)malloc(sizeof(threadstart));
+	pthread_t thread;
+
+	if (pts == NULL)
+		return false;
+	pts->entry = entry;
+	pts->arg = arg;
+
+	if (pthread_create(&thread, NULL, threadTrampoline, pts) != 0)
+	{
+		free(pts);
+		return false;
+	}
+	pthread_detach(thread);
+
+	return true;
+}
+
+uint64_t threadIdentifier(void)
+{
+#ifdef __linux__
+	// Kernel thread id, as shown by ps and top.
+	return (uint64_t)syscall(SYS_gettid);
+#else
+	return (uint64_t)(uintptr_t)pthread_self();
+#endif
+}
+
+unsigned int processorCount(void)
+{
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+	return n > 0 ? (unsigned int)n : 1;
+}
+
+size_t allocationSize(void *p)
+{
+#if defined(__linux__)
+	return malloc_usable_size(p);
+#elif defined(__APPLE__)
+	return malloc_size(p);
+#else
+	(void)p;
+	return 0;
+#endif
+}
+
+// Actions in place before signalInstall().
+static struct sigaction signalPrevious[MEM_SIGNALS];
+
+bool signalInstall(int sig, void (*handler)(int), bool replace)
+{
+	struct sigaction sa, previous;
+
+	// Leave a handler the program installed (or an ignored signal) alone.
+	if (sigaction(sig, NULL, &previous) != 0)
+		return false;
+	if (!replace && ((previous.sa_flags & SA_SIGINFO) || previous.sa_handler != SIG_DFL))
+		return false;
+
+	for (int i = 0; i < MEM_SIGNALS; i++)
+		if (signalNumbers[i] == 0 || signalNumbers[i] == sig)
+		{
+			signalNumbers[i] = sig;
+			signalPrevious[i] = previous;
+			break;
+		}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = handler;
+	sa.sa_flags = SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+
+	return (bool)(sigaction(sig, &sa, NULL) == 0);
+}
+
+void signalRestore(int sig)
+{
+	struct sigaction sa;
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_handler = SIG_DFL;
+	sigemptyset(&sa.sa_mask);
+	for (int i = 0; i < MEM_SIGNALS; i++)
+		if (signalNumbers[i] == sig)
+			sa = signalPrevious[i];
+	sigaction(sig, &sa, NULL);
+}
+
+void writeDescriptor(int fd, const void *pBuf, size_t length)
+{
+	const char *p = (const char *)pBuf;
+
+	while (length > 0)
+	{
+		ssize_t n = write(fd, p, length);
+
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return;
+		p += n;
+		length -= (size_t)n;
+	}
+}
+
+// The precise clock is read in user space (the vDSO, from the TSC where the
+// kernel uses it) in a few tens of ns. The coarse clock is cheaper still,
+// but only ticks every 1 to 4 ms, coarser than the 1 ms lifetime which
+// marks a pooling candidate.
+#if defined(MEMTRACK_COARSE_CLOCK) && defined(CLOCK_MONOTONIC_COARSE)
+#define MEM_CLOCK CLOCK_MONOTONIC_COARSE
+#else
+#define MEM_CLOCK CLOCK_MONOTONIC
+#endif
+
+uint64_t clockNanoseconds(void)
+{
+	struct timespec ts;
+
+	clock_gettime(MEM_CLOCK, &ts);
+
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void *memoryReserve(size_t length)
+{
+	void *p = mmap(NULL, length, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	return p == MAP_FAILED ? NULL : p;
+}
+
+bool memoryCommit(void *p, size_t length)
+{
+	return (bool)(mprotect(p, length, PROT_READ | PROT_WRITE) == 0);
+}
+
+void memoryRelease(void *p, size_t length)
+{
+	munmap(p, length);
+}
+
+#endif
+
+#endif
@@ -0,0 +1,158 @@
+/*************************************************************************
+* Title: memTracker
+* File: memPlatform.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the thin operating system layer used by memTracker
+* (atomics, locks, semaphores, threads, thread local storage, signals,
+* raw descriptor output, virtual memory and the monotonic clock).
+*
+* Notes:
+*  (1) Windows builds use SRW locks and Win32 semaphores/threads, all
+*      other builds use POSIX threads and semaphores.
+*  (2) Not compiled when tracking is off.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added virtual memory reserve/commit/release. JME
+*   10/19/2026: Added processorCount(), semaphoreDestroy(). JME
+*   10/19/2026: Added allocationSize(). JME
+*   10/19/2026: Added signalRestore(). JME
+*   10/19/2026: Added semaphoreWaitFor(). JME
+*   10/19/2026: Added atomicStore(). JME
+*************************************************************************/
+#ifndef _MEM_PLATFORM_H_
+#define _MEM_PLATFORM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <signal.h>
+#include "memLevel.h"
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+#ifdef _WIN32
+#include <windows.h>
+typedef SRWLOCK memlock;
+typedef HANDLE memsemaphore;
+#define MEM_LOCK_INIT SRWLOCK_INIT
+#define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#include <pthread.h>
+#include <semaphore.h>
+typedef pthread_mutex_t memlock;
+typedef sem_t memsemaphore;
+#define MEM_LOCK_INIT PTHREAD_MUTEX_INITIALIZER
+#define MEM_THREAD_LOCAL __thread
+#endif
+
+// Standard descriptor used for reports unless redirected.
+#define MEM_STDERR_FD 2
+
+// Thread entry point signature.
+typedef void (*memthreadentry)(void *);
+
+// Atomic 64 bit operations (relaxed ordering). atomicAdd() returns the new value.
+#ifdef _WIN32
+static inline uint64_t atomicAdd(volatile uint64_t *p, uint64_t value)
+{
+	return (uint64_t)InterlockedExchangeAdd64((volatile LONG64 *)p, (LONG64)value) + value;
+}
+
+static inline uint64_t atomicLoad(volatile uint64_t *p)
+{
+	return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)p, 0, 0);
+}
+
+static inline bool atomicCompareSwap(volatile uint64_t *p, uint64_t expected, uint64_t desired)
+{
+	return (bool)((uint64_t)InterlockedCompareExchange64((volatile LONG64 *)p, (LONG64)desired, (LONG64)expected) == expected);
+}
+
+// Store from the only writer of p.
+static inline void atomicStore(volatile uint64_t *p, uint64_t value)
+{
+#ifdef _WIN64
+	*p = value;
+#else
+	InterlockedExchange64((volatile LONG64 *)p, (LONG64)value);
+#endif
+}
+#else
+static inline uint64_t atomicAdd(volatile uint64_t *p, uint64_t value)
+{
+	return __atomic_add_fetch(p, value, __ATOMIC_RELAXED);
+}
+
+static inline uint64_t atomicLoad(volatile uint64_t *p)
+{
+	return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static inline bool atomicCompareSwap(volatile uint64_t *p, uint64_t expected, uint64_t desired)
+{
+	return __atomic_compare_exchange_n(p, &expected, desired, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+// Store from the only writer of p.
+static inline void atomicStore(volatile uint64_t *p, uint64_t value)
+{
+	__atomic_store_n(p, value, __ATOMIC_RELAXED);
+}
+#endif
+
+// Mutual exclusion (not recursive).
+void lockAcquire(memlock *);
+void lockRelease(memlock *);
+
+// Counting semaphore, semaphorePost() is async-signal-safe.
+bool semaphoreCreate(memsemaphore *);
+void semaphorePost(memsemaphore *);
+void semaphoreWait(memsemaphore *);
+bool semaphoreWaitFor(memsemaphore *, uint64_t);
+void semaphoreDestroy(memsemaphore *);
+
+// Start a detached thread.
+bool threadStart(memthreadentry, void *);
+
+// Operating system identifier of the calling thread.
+uint64_t threadIdentifier(void);
+
+// Number of online processors (at least 1).
+unsigned int processorCount(void);
+
+// Install a signal handler (restarting interrupted system calls where
+// supported), keeping the previous one. Unless replacing, a handler the
+// program installed is left in place and false returned.
+bool signalInstall(int, void (*)(int), bool);
+
+// Put back the handler in place before signalInstall(), or the default.
+// Async-signal-safe.
+void signalRestore(int);
+
+// Async-signal-safe raw write of the whole buffer to a descriptor.
+void writeDescriptor(int, const void *, size_t);
+
+// Monotonic clock in nanoseconds (arbitrary origin). Precise unless
+// MEMTRACK_COARSE_CLOCK is defined (see memPlatform.c).
+uint64_t clockNanoseconds(void);
+
+// Reserve address space (inaccessible until committed), NULL on failure.
+void *memoryReserve(size_t);
+
+// Make part of a reservation readable and writable. Address and length
+// must be multiples of the page size.
+bool memoryCommit(void *, size_t);
+
+// Release a whole reservation.
+void memoryRelease(void *, size_t);
+
+// Usable size of a system allocator block, 0 if unknown.
+size_t allocationSize(void *);
+
+#endif
+
+#endif
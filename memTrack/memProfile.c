@@ -0,0 +1,380 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memProfile.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file keeps the allocation profile. Each allocation site (file and
+* line) is looked up in a fixed size hash table, counting allocations and
+* building a histogram of block lifetimes as blocks are freed. Sites with
+* many short lived blocks are reported as candidates for pools or arenas.
+* A timeline of total tracked memory is sampled as allocations occur, and
+* by the reporter thread while they do not.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added streamSite(). JME
+*   10/19/2026: Live bytes and watermark per site, site snapshots. JME
+*   10/19/2026: Added timelineWait(). JME
+*   10/19/2026: Site watermarks and snapshots scaled at the sampled level. JME
+*   10/19/2026: Added profileBytes(). JME
+*************************************************************************/
+#include "memProfile.h"
+
+// Only compiled at the sampled and full tracking levels.
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Number of pooling candidates listed.
+#define POOL_REPORT_MAX 16
+
+// Total memory at a point in time.
+typedef struct TIMESAMPLE {
+	uint64_t time;  // Sample time (ns).
+	size_t total;   // Total tracked memory.
+} timesample;
+
+// Site table, slot 0 collects sites which did not fit.
+static allocsite sites[MEMTRACK_MAX_SITES] = { [0] = { .file = "(other)", .trigger = UINT64_MAX } };
+static uint32_t siteCount = 1;
+
+// Live bytes of a site which trigger a capture (0 if none).
+static uint64_t siteWatermark = 0;
+
+// Timeline of total memory.
+static timesample timeline[MEMTRACK_TIMELINE_SAMPLES];
+static size_t timelineCount = 0;
+static uint64_t timelineInterval = MEMTRACK_TIMELINE_INTERVAL_MS * 1000000ull;
+static uint64_t timelineNext = 0;
+
+// Lifetime bucket labels and upper limits (ns).
+static const char *lifetimeLabels[LIFETIME_BUCKETS] = { "<1us", "<10us", "<100us", "<1ms", "<10ms", "<100ms", "<1s", ">=1s" };
+static const uint64_t lifetimeLimits[LIFETIME_BUCKETS - 1] = { 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull };
+
+// Return site index for file and line, adding it if new.
+uint32_t siteLookup(const char *file, int line)
+{
+	uint32_t hash = (uint32_t)(((uintptr_t)file >> 3) ^ ((uint32_t)line * 2654435761u));
+	uint32_t i = hash & (MEMTRACK_MAX_SITES - 1);
+
+	// Linear probe, skipping the overflow slot.
+	for (;;)
+	{
+		if (i == 0)
+			i = 1;
+
+		if (sites[i].file == file && sites[i].line == line)
+			return i;
+
+		if (sites[i].file == NULL)
+		{
+			// Keep one slot free so probes always terminate.
+			if (siteCount >= MEMTRACK_MAX_SITES - 1)
+				return 0;
+
+			sites[i].file = file;
+			sites[i].line = line;
+			sites[i].trigger = siteWatermark ? siteWatermark : UINT64_MAX;
+			siteCount++;
+			return i;
+		}
+
+		i = (i + 1) & (MEMTRACK_MAX_SITES - 1);
+	}
+}
+
+// True, and disarmed, if a site's live bytes crossed its watermark.
+static bool siteCrossed(allocsite *ps)
+{
+	if (ps->liveBytes <= ps->trigger)
+		return false;
+
+	ps->trigger = UINT64_MAX;
+	return true;
+}
+
+// Re-arm a site's watermark once its live bytes fall back.
+static void siteRearm(allocsite *ps)
+{
+	if (ps->trigger == UINT64_MAX && siteWatermark && ps->liveBytes < WATERMARK_REARM(siteWatermark))
+		ps->trigger = siteWatermark;
+}
+
+// Count an allocation against a site. True if it crossed its watermark.
+bool siteAllocated(uint32_t site, size_t size, uint64_t now)
+{
+	allocsite *ps = &sites[site];
+
+	if (ps->allocations++ == 0)
+		ps->firstTime = now;
+	ps->lastTime = now;
+	ps->bytes += size;
+	ps->liveBytes += size;
+
+	return siteCrossed(ps);
+}
+
+// Count a free against a site, adding the block lifetime to its histogram.
+void siteFreed(uint32_t site, size_t size, uint64_t lifetime)
+{
+	allocsite *ps = &sites[site];
+	int bucket = 0;
+
+	while (bucket < LIFETIME_BUCKETS - 1 && lifetime >= lifetimeLimits[bucket])
+		bucket++;
+
+	ps->frees++;
+	ps->lifetimeTotal += lifetime;
+	ps->lifetimes[bucket]++;
+	ps->liveBytes -= size;
+	siteRearm(ps);
+}
+
+// Count a resize against a site. True if it crossed its watermark.
+bool siteResized(uint32_t site, size_t sizeOld, size_t sizeNew)
+{
+	allocsite *ps = &sites[site];
+
+	ps->liveBytes = ps->liveBytes - sizeOld + sizeNew;
+	siteRearm(ps);
+
+	return siteCrossed(ps);
+}
+
+// Set the live bytes of a site which trigger a capture (0 for none).
+void siteSetWatermark(uint64_t bytes)
+{
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	// Only 1 in MEMTRACK_SAMPLE_RATE blocks of a site is counted.
+	bytes = (bytes + MEMTRACK_SAMPLE_RATE - 1) / MEMTRACK_SAMPLE_RATE;
+#endif
+	siteWatermark = bytes;
+
+	for (uint32_t i = 0; i < MEMTRACK_MAX_SITES; i++)
+		if (sites[i].file != NULL)
+			sites[i].trigger = bytes ? bytes : UINT64_MAX;
+}
+
+// Copy the sites holding live memory, returning how many. At the sampled
+// level the counts are scaled up to estimate all blocks of a site.
+uint32_t siteSnapshot(sitesnapshot *pSnapshot)
+{
+	uint32_t count = 0;
+
+	for (uint32_t i = 0; i < MEMTRACK_MAX_SITES; i++)
+		if (sites[i].liveBytes != 0)
+		{
+			pSnapshot[count].file = sites[i].file;
+			pSnapshot[count].line = sites[i].line;
+			pSnapshot[count].site = i;
+			pSnapshot[count].liveBytes = sites[i].liveBytes;
+			pSnapshot[count].liveBlocks = sites[i].allocations - sites[i].frees;
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+			pSnapshot[count].liveBytes *= MEMTRACK_SAMPLE_RATE;
+			pSnapshot[count].liveBlocks *= MEMTRACK_SAMPLE_RATE;
+#endif
+			count++;
+		}
+
+	return count;
+}
+
+// True once the sample interval has elapsed.
+bool timelineDue(uint64_t now)
+{
+	return (bool)(now >= timelineNext);
+}
+
+// Time until the next sample is due (ns), 0 if due.
+uint64_t timelineWait(uint64_t now)
+{
+	return timelineNext > now ? timelineNext - now : 0;
+}
+
+// Record total memory.
+void timelineSample(uint64_t now, size_t total)
+{
+	// Full, keep every other sample and halve the sample rate.
+	if (timelineCount == MEMTRACK_TIMELINE_SAMPLES)
+	{
+		for (size_t i = 0; i < MEMTRACK_TIMELINE_SAMPLES / 2; i++)
+			timeline[i] = timeline[2 * i];
+		timelineCount = MEMTRACK_TIMELINE_SAMPLES / 2;
+		timelineInterval *= 2;
+	}
+
+	timeline[timelineCount].time = now;
+	timeline[timelineCount].total = total;
+	timelineCount++;
+	timelineNext = now + timelineInterval;
+}
+
+// Change the timeline sample interval (ns).
+void timelineSetInterval(uint64_t interval)
+{
+	timelineInterval = interval ? interval : 1;
+	timelineNext = 0;
+}
+
+// Return bytes held by the site table and timeline.
+size_t profileBytes(void)
+{
+	return sizeof(sites) + sizeof(timeline);
+}
+
+// Allocations per second over the active period of a site.
+static uint64_t siteRate(const allocsite *ps)
+{
+	uint64_t span = ps->lastTime - ps->firstTime;
+
+	if (span == 0)
+		return 0;
+	return (uint64_t)((double)ps->allocations * 1e9 / (double)span);
+}
+
+// Percentage of freed blocks which lived less than 1 ms.
+static uint64_t siteShortPercent(const allocsite *ps)
+{
+	uint64_t shortLived = 0;
+
+	if (ps->frees == 0)
+		return 0;
+	for (int i = 0; i < LIFETIME_SHORT_BUCKETS; i++)
+		shortLived += ps->lifetimes[i];
+
+	return shortLived * 100 / ps->frees;
+}
+
+// Append site location.
+static void streamSiteName(memstream *ms, const allocsite *ps)
+{
+	streamPuts(ms, ps->file);
+	streamPuts(ms, ":");
+	streamUnsigned(ms, (uint64_t)ps->line);
+}
+
+// Append location of a site.
+void streamSite(memstream *ms, uint32_t site)
+{
+	streamSiteName(ms, &sites[site]);
+}
+
+// Stream site statistics from cursor until the chunk fills. Returns true when done.
+bool streamSites(memstream *ms, size_t *cursor)
+{
+	for (; *cursor < MEMTRACK_MAX_SITES; (*cursor)++)
+	{
+		const allocsite *ps = &sites[*cursor];
+
+		if (streamFull(ms))
+			return false;
+		if (ps->allocations == 0)
+			continue;
+
+		streamSiteName(ms, ps);
+		streamPuts(ms, " allocs: ");
+		streamUnsigned(ms, ps->allocations);
+		streamPuts(ms, " live: ");
+		streamUnsigned(ms, ps->allocations - ps->frees);
+		streamPuts(ms, " bytes: ");
+		streamUnsigned(ms, ps->bytes);
+		streamPuts(ms, " rate: ");
+		streamUnsigned(ms, siteRate(ps));
+		streamPuts(ms, "/s mean: ");
+		streamUnsigned(ms, ps->frees ? ps->lifetimeTotal / ps->frees : 0);
+		streamPuts(ms, "ns [");
+
+		// Lifetime histogram.
+		for (int i = 0; i < LIFETIME_BUCKETS; i++)
+			if (ps->lifetimes[i])
+			{
+				streamPuts(ms, " ");
+				streamPuts(ms, lifetimeLabels[i]);
+				streamPuts(ms, ":");
+				streamUnsigned(ms, ps->lifetimes[i]);
+			}
+		streamPuts(ms, " ]\n");
+	}
+
+	return true;
+}
+
+// Stream timeline samples from cursor until the chunk fills. Returns true when done.
+bool streamTimeline(memstream *ms, size_t *cursor)
+{
+	for (; *cursor < timelineCount; (*cursor)++)
+	{
+		if (streamFull(ms))
+			return false;
+
+		streamPuts(ms, "+");
+		streamUnsigned(ms, (timeline[*cursor].time - timeline[0].time) / 1000000);
+		streamPuts(ms, "ms total: ");
+		streamUnsigned(ms, timeline[*cursor].total);
+		streamPuts(ms, "\n");
+	}
+
+	return true;
+}
+
+// Stream the sites with the highest allocation rate among those whose
+// blocks are mostly short lived, these gain most from a pool or arena.
+void streamPoolCandidates(memstream *ms)
+{
+	uint32_t best[POOL_REPORT_MAX];
+	uint64_t bestRate[POOL_REPORT_MAX];
+	int count = 0;
+
+	for (uint32_t i = 0; i < MEMTRACK_MAX_SITES; i++)
+	{
+		const allocsite *ps = &sites[i];
+		uint64_t rate;
+		int j;
+
+		if (ps->frees < MEMTRACK_POOL_MIN_FREES || siteShortPercent(ps) < MEMTRACK_POOL_SHORT_PERCENT)
+			continue;
+
+		// Insert into list ordered by descending rate.
+		rate = siteRate(ps);
+		for (j = count; j > 0 && bestRate[j - 1] < rate; j--)
+			if (j < POOL_REPORT_MAX)
+			{
+				best[j] = best[j - 1];
+				bestRate[j] = bestRate[j - 1];
+			}
+		if (j < POOL_REPORT_MAX)
+		{
+			best[j] = i;
+			bestRate[j] = rate;
+			if (count < POOL_REPORT_MAX)
+				count++;
+		}
+	}
+
+	if (count == 0)
+		return;
+
+	streamPuts(ms, "\nPool candidates (short lived, high churn):\n");
+	for (int j = 0; j < count; j++)
+	{
+		const allocsite *ps = &sites[best[j]];
+
+		streamSiteName(ms, ps);
+		streamPuts(ms, " rate: ");
+		streamUnsigned(ms, bestRate[j]);
+		streamPuts(ms, "/s short lived: ");
+		streamUnsigned(ms, siteShortPercent(ps));
+		streamPuts(ms, "% allocs: ");
+		streamUnsigned(ms, ps->allocations);
+		streamPuts(ms, " avg size: ");
+		streamUnsigned(ms, ps->bytes / ps->allocations);
+		streamPuts(ms, "\n");
+	}
+}
+
+#endif
@@ -0,0 +1,114 @@
+/*************************************************************************
+* Title: memTracker
+* File: memProfile.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the allocation profile kept by memTracker: per site
+* (file and line) allocation counts and lifetime histograms, plus a
+* timeline of total tracked memory. Each site also keeps its live bytes
+* against an optional watermark (see memWatch.h).
+*
+* Notes:
+*  (1) All functions must be called with the tracker lock held.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: At most 65536 sites (see memStore.h). JME
+*   10/19/2026: Added streamSite(). JME
+*   10/19/2026: Live bytes and watermark per site, site snapshots. JME
+*   10/19/2026: Added timelineWait(). JME
+*   10/19/2026: Added profileBytes(). JME
+*************************************************************************/
+#ifndef _MEM_PROFILE_H_
+#define _MEM_PROFILE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memStream.h"
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Number of distinct allocation sites tracked (power of 2, at most
+// 65536). Sites beyond this are counted against site 0.
+#ifndef MEMTRACK_MAX_SITES
+#define MEMTRACK_MAX_SITES 4096
+#endif
+
+// Number of timeline samples kept. When full, every other sample is
+// dropped and the interval doubled.
+#ifndef MEMTRACK_TIMELINE_SAMPLES
+#define MEMTRACK_TIMELINE_SAMPLES 1024
+#endif
+
+// Default timeline sampling interval.
+#ifndef MEMTRACK_TIMELINE_INTERVAL_MS
+#define MEMTRACK_TIMELINE_INTERVAL_MS 10
+#endif
+
+// A site is a pooling candidate after this many frees, if at least
+// MEMTRACK_POOL_SHORT_PERCENT of them lived less than 1 ms.
+#ifndef MEMTRACK_POOL_MIN_FREES
+#define MEMTRACK_POOL_MIN_FREES 100
+#endif
+#ifndef MEMTRACK_POOL_SHORT_PERCENT
+#define MEMTRACK_POOL_SHORT_PERCENT 50
+#endif
+
+// A watermark crossed is re-armed once live memory falls this percentage
+// below it, so memory hovering around it does not trigger repeatedly.
+#ifndef MEMTRACK_WATERMARK_HYSTERESIS
+#define MEMTRACK_WATERMARK_HYSTERESIS 10
+#endif
+#define WATERMARK_REARM(bytes) ((bytes) - (bytes) / 100 * MEMTRACK_WATERMARK_HYSTERESIS)
+
+// Lifetime histogram, one bucket per decade from 1 us to 1 s.
+#define LIFETIME_BUCKETS       8
+#define LIFETIME_SHORT_BUCKETS 4 // Buckets below 1 ms.
+
+// Allocation statistics for one site.
+typedef struct ALLOCSITE {
+	const char *file;                     // Source file (NULL if unused).
+	int line;                             // Source line.
+	uint64_t allocations;                 // Number of allocations.
+	uint64_t frees;                       // Number of frees.
+	uint64_t bytes;                       // Total bytes allocated.
+	uint64_t liveBytes;                   // Bytes currently allocated.
+	uint64_t trigger;                     // Watermark, UINT64_MAX if none or crossed.
+	uint64_t lifetimeTotal;               // Sum of lifetimes of freed blocks (ns).
+	uint64_t firstTime;                   // Time of first allocation (ns).
+	uint64_t lastTime;                    // Time of last allocation (ns).
+	uint64_t lifetimes[LIFETIME_BUCKETS]; // Lifetime histogram of freed blocks.
+} allocsite;
+
+// Live memory of one site, see siteSnapshot().
+typedef struct SITESNAPSHOT {
+	const char *file;    // Source file.
+	int line;            // Source line.
+	uint32_t site;       // Site index.
+	uint64_t liveBytes;  // Bytes currently allocated.
+	uint64_t liveBlocks; // Blocks currently allocated.
+} sitesnapshot;
+
+uint32_t siteLookup(const char *, int);
+bool siteAllocated(uint32_t, size_t, uint64_t);
+void siteFreed(uint32_t, size_t, uint64_t);
+bool siteResized(uint32_t, size_t, size_t);
+void siteSetWatermark(uint64_t);
+uint32_t siteSnapshot(sitesnapshot *);
+bool timelineDue(uint64_t);
+uint64_t timelineWait(uint64_t);
+void timelineSample(uint64_t, size_t);
+void timelineSetInterval(uint64_t);
+size_t profileBytes(void);
+bool streamSites(memstream *, size_t *);
+bool streamTimeline(memstream *, size_t *);
+void streamPoolCandidates(memstream *);
+void streamSite(memstream *, uint32_t);
+
+#endif
+
+#endif
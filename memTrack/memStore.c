@@ -0,0 +1,276 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memStore.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the block record store. A record costs 20 bytes
+* spread over four arrays, which grow by half, and released records are
+* reused. A block finds its record through the index kept in its
+* header, storeFind() is only needed when the header has been overwritten
+* and is a plain scan of the address and size arrays. An address ordered
+* view is sorted on demand for bulk lookups.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added storeSorted(). JME
+*   10/19/2026: Added storeBytes(). JME
+*   10/19/2026: storeSorted() keeps its view until records change. JME
+*   10/19/2026: 32 bit allocation times, arrays grow by half. JME
+*************************************************************************/
+#include "memStore.h"
+
+// Only compiled at the sampled and full tracking levels.
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Initial number of records.
+#define STORE_INITIAL_CAPACITY 1024
+
+// Size of a record too large for the size array.
+typedef struct SIZEOVERFLOW {
+	uint32_t index;
+	size_t size;
+} sizeoverflow;
+
+blockstore blocks = { .freeHead = BLOCK_NONE };
+
+static sizeoverflow *overflows = NULL;
+static size_t overflowCount = 0;
+
+// Records in use in address order, rebuilt once records are created,
+// released or moved.
+static uint32_t *sortedView = NULL;
+static uint32_t sortedCount = 0;
+static uint32_t sortedCapacity = 0;
+static bool sortedStale = true;
+
+// Return position of a record in the overflow table.
+static size_t overflowFind(uint32_t index)
+{
+	size_t i;
+
+	for (i = 0; i < overflowCount && overflows[i].index != index; i++)
+		;
+
+	assert(i < overflowCount);
+
+	return i;
+}
+
+// Remove a record from the overflow table.
+static void overflowRemove(uint32_t index)
+{
+	size_t i = overflowFind(index);
+
+	// Found before the count falls, the last entry may be the one removed.
+	overflows[i] = overflows[--overflowCount];
+}
+
+// Grow the arrays by half, so at most a third of them is unused. The old
+// arrays stay valid if any allocation fails.
+static bool storeGrow(void)
+{
+	uint64_t capacity = blocks.capacity ? blocks.capacity + blocks.capacity / 2 : STORE_INITIAL_CAPACITY;
+	void *p;
+
+	if (capacity >= BLOCK_NONE)
+		capacity = BLOCK_NONE - 1;
+	if (capacity <= blocks.capacity)
+		return false;
+
+	if ((p = realloc(blocks.pMem, capacity * sizeof(uint8_t *))) == NULL)
+		return false;
+	blocks.pMem = (uint8_t **)p;
+	if ((p = realloc(blocks.size, capacity * sizeof(uint32_t))) == NULL)
+		return false;
+	blocks.size = (uint32_t *)p;
+	if ((p = realloc(blocks.tag, capacity * sizeof(uint32_t))) == NULL)
+		return false;
+	blocks.tag = (uint32_t *)p;
+	if ((p = realloc(blocks.allocTime, capacity * sizeof(uint32_t))) == NULL)
+		return false;
+	blocks.allocTime = (uint32_t *)p;
+
+	blocks.capacity = (uint32_t)capacity;
+
+	return true;
+}
+
+// Create a record, returning its index (BLOCK_NONE on failure).
+uint32_t storeCreate(uint8_t *pMem, size_t size, uint32_t tag, uint32_t time)
+{
+	uint32_t index;
+
+	// Reuse a released record, else take the next one.
+	if (blocks.freeHead != BLOCK_NONE)
+	{
+		index = blocks.freeHead;
+		blocks.freeHead = blocks.size[index];
+	}
+	else
+	{
+		if (blocks.count == blocks.capacity && !storeGrow())
+			return BLOCK_NONE;
+		index = blocks.count++;
+	}
+
+	blocks.pMem[index] = pMem;
+	blocks.size[index] = 0;
+	blocks.tag[index] = tag;
+	blocks.allocTime[index] = time;
+	storeSetSize(index, size);
+	sortedStale = true;
+
+	return index;
+}
+
+// Release a record for reuse.
+void storeRelease(uint32_t index)
+{
+	if (blocks.size[index] == UINT32_MAX)
+		overflowRemove(index);
+
+	blocks.pMem[index] = NULL;
+	blocks.tag[index] = 0;
+	blocks.size[index] = blocks.freeHead;
+	blocks.freeHead = index;
+	sortedStale = true;
+}
+
+// Change the memory of a record (a block which moved).
+void storeSetMemory(uint32_t index, uint8_t *pMem)
+{
+	if (blocks.pMem[index] != pMem)
+	{
+		blocks.pMem[index] = pMem;
+		sortedStale = true;
+	}
+}
+
+// Return size of a record.
+size_t storeSize(uint32_t index)
+{
+	if (blocks.size[index] != UINT32_MAX)
+		return blocks.size[index];
+
+	return overflows[overflowFind(index)].size;
+}
+
+// Change size of a record.
+void storeSetSize(uint32_t index, size_t size)
+{
+	bool overflowed = (bool)(blocks.size[index] == UINT32_MAX);
+
+	if ((uint64_t)size < UINT32_MAX)
+	{
+		if (overflowed)
+			overflowRemove(index);
+		blocks.size[index] = (uint32_t)size;
+		return;
+	}
+
+	if (overflowed)
+	{
+		overflows[overflowFind(index)].size = size;
+		return;
+	}
+
+	// Rare, so the table grows one entry at a time.
+	sizeoverflow *p = (sizeoverflow *)realloc(overflows, (overflowCount + 1) * sizeof(sizeoverflow));
+
+	assert(p != NULL);
+	overflows = p;
+	overflows[overflowCount].index = index;
+	overflows[overflowCount].size = size;
+	overflowCount++;
+	blocks.size[index] = UINT32_MAX;
+}
+
+// Return the record of the block containing the pointer, BLOCK_NONE if none.
+uint32_t storeFind(const uint8_t *pMem)
+{
+	for (uint32_t i = 0; i < blocks.count; i++)
+		if (blocks.tag[i] != 0 && (uintptr_t)pMem - (uintptr_t)blocks.pMem[i] < blocks.size[i])
+			return i;
+
+	return BLOCK_NONE;
+}
+
+// Order records by address.
+static int compareAddress(const void *a, const void *b)
+{
+	uintptr_t pa = (uintptr_t)blocks.pMem[*(const uint32_t *)a];
+	uintptr_t pb = (uintptr_t)blocks.pMem[*(const uint32_t *)b];
+
+	return (pa > pb) - (pa < pb);
+}
+
+// True if storeSorted() would not need to sort.
+bool storeSortedCurrent(void)
+{
+	return (bool)!sortedStale;
+}
+
+// Return the records in use sorted by address, NULL if out of memory. The
+// view belongs to the store and is valid until records change.
+const uint32_t *storeSorted(uint32_t *pCount)
+{
+	if (sortedStale)
+	{
+		if (blocks.count > sortedCapacity)
+		{
+			uint32_t *p = (uint32_t *)realloc(sortedView, blocks.count * sizeof(uint32_t));
+
+			if (p == NULL)
+				return NULL;
+			sortedView = p;
+			sortedCapacity = blocks.count;
+		}
+
+		sortedCount = 0;
+		for (uint32_t i = 0; i < blocks.count; i++)
+			if (blocks.tag[i] != 0)
+				sortedView[sortedCount++] = i;
+
+		qsort(sortedView, sortedCount, sizeof(uint32_t), compareAddress);
+		sortedStale = false;
+	}
+
+	*pCount = sortedCount;
+
+	return sortedView;
+}
+
+// Return bytes held by the record arrays, sorted view and overflow table.
+size_t storeBytes(void)
+{
+	return (size_t)blocks.capacity * (sizeof(uint8_t *) + 3 * sizeof(uint32_t))
+		+ (size_t)sortedCapacity * sizeof(uint32_t) + overflowCount * sizeof(sizeoverflow);
+}
+
+// Release all records.
+void storeDestroy(void)
+{
+	free(blocks.pMem);
+	free(blocks.size);
+	free(blocks.tag);
+	free(blocks.allocTime);
+	free(overflows);
+	free(sortedView);
+
+	memset(&blocks, 0, sizeof(blockstore));
+	blocks.freeHead = BLOCK_NONE;
+	overflows = NULL;
+	overflowCount = 0;
+	sortedView = NULL;
+	sortedCount = sortedCapacity = 0;
+	sortedStale = true;
+}
+
+#endif
@@ -0,0 +1,84 @@
+/*************************************************************************
+* Title: memTracker
+* File: memStore.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the block record store of memTracker. Records are
+* kept as parallel arrays (structure of arrays) indexed by record number,
+* one element per tracked block in each: the user memory address, a 32 bit
+* size, a packed tag (status, thread and site) and a 32 bit allocation
+* time. Sizes which do not fit 32 bits are kept in a small overflow table.
+*
+* Notes:
+*  (1) All functions must be called with the tracker lock held.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added storeSorted(). JME
+*   10/19/2026: Added storeBytes(). JME
+*   10/19/2026: storeSorted() keeps its view until records change. JME
+*   10/19/2026: Allocation times kept in 32 bits (STORE_TIME). JME
+*************************************************************************/
+#ifndef _MEM_STORE_H_
+#define _MEM_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memTrack.h"
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+#include "memThread.h"
+#include "memProfile.h"
+
+#if MEMTRACK_MAX_THREADS > 4096 || MEMTRACK_MAX_SITES > 65536
+#error Thread and site numbers must fit the record tag.
+#endif
+
+// No record.
+#define BLOCK_NONE UINT32_MAX
+
+// Record tag: status in bits 0-3, thread in bits 4-15, site in bits 16-31.
+#define TAG_MAKE(status, thread, site) ((uint32_t)(status) | ((uint32_t)(thread) << 4) | ((uint32_t)(site) << 16))
+#define TAG_STATUS(tag) ((unsigned char)((tag) & 0x0F))
+#define TAG_THREAD(tag) ((uint32_t)((tag) >> 4) & 0x0FFF)
+#define TAG_SITE(tag)   ((uint32_t)((tag) >> 16))
+
+// Allocation times are kept in units of 1024 ns, so wrap after about 73
+// minutes. Lifetimes are taken modulo that, which only misplaces a block
+// living just over a multiple of it.
+#define STORE_TIME_SHIFT 10
+#define STORE_TIME(ns) ((uint32_t)((ns) >> STORE_TIME_SHIFT))
+#define STORE_LIFETIME(index, ns) ((uint64_t)(uint32_t)(STORE_TIME(ns) - blocks.allocTime[index]) << STORE_TIME_SHIFT)
+
+// Block records, element i of each array describes record i.
+typedef struct BLOCKSTORE {
+	uint8_t **pMem;      // User memory (NULL for released records).
+	uint32_t *size;      // Block size, UINT32_MAX if held in the overflow table.
+	uint32_t *tag;       // Status, thread and site (0 for released records).
+	uint32_t *allocTime; // Time of allocation (STORE_TIME).
+	uint32_t count;      // Records ever used, released ones included.
+	uint32_t capacity;   // Length of the arrays.
+	uint32_t freeHead;   // First released record, linked through size.
+} blockstore;
+
+extern blockstore blocks;
+
+uint32_t storeCreate(uint8_t *, size_t, uint32_t, uint32_t);
+void storeRelease(uint32_t);
+size_t storeSize(uint32_t);
+void storeSetSize(uint32_t, size_t);
+uint32_t storeFind(const uint8_t *);
+void storeSetMemory(uint32_t, uint8_t *);
+bool storeSortedCurrent(void);
+const uint32_t *storeSorted(uint32_t *);
+size_t storeBytes(void);
+void storeDestroy(void);
+
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memStream.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the bounded report stream. Only integer and string
+* formatting is supported, which is all the reports need, and keeps every
+* function safe to call from a signal handler.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Not compiled when tracking is off.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*************************************************************************/
+#include "memStream.h"
+#include "memPlatform.h"
+
+// Nothing is compiled when tracking is off.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// Prepare stream for output to descriptor.
+void streamOpen(memstream *ms, int fd)
+{
+	ms->fd = fd;
+	ms->length = 0;
+}
+
+// Write pending output to the descriptor.
+void streamFlush(memstream *ms)
+{
+	if (ms->length > 0)
+		writeDescriptor(ms->fd, ms->buffer, ms->length);
+	ms->length = 0;
+}
+
+// True when the buffer can no longer be guaranteed to hold another line.
+bool streamFull(const memstream *ms)
+{
+	return (bool)(ms->length > MEMSTREAM_CHUNK - MEMSTREAM_LINE_MAX);
+}
+
+// Append a string, flushing whenever the buffer fills.
+void streamPuts(memstream *ms, const char *s)
+{
+	while (*s)
+	{
+		if (ms->length == MEMSTREAM_CHUNK)
+			streamFlush(ms);
+		ms->buffer[ms->length++] = *s++;
+	}
+}
+
+// Append an unsigned decimal value.
+void streamUnsigned(memstream *ms, uint64_t value)
+{
+	char digits[24];
+	char *p = digits + sizeof(digits) - 1;
+
+	*p = '\0';
+	do {
+		*--p = (char)('0' + value % 10);
+		value /= 10;
+	} while (value);
+
+	streamPuts(ms, p);
+}
+
+// Append a hexadecimal address, 0x prefixed.
+void streamHex(memstream *ms, uintptr_t value)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	char digits[2 * sizeof(uintptr_t) + 3];
+	char *p = digits + sizeof(digits) - 1;
+
+	*p = '\0';
+	do {
+		*--p = hexDigits[value & 0xF];
+		value >>= 4;
+	} while (value);
+	*--p = 'x';
+	*--p = '0';
+
+	streamPuts(ms, p);
+}
+
+#endif
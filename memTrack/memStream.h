@@ -0,0 +1,50 @@
+/*************************************************************************
+* Title: memTracker
+* File: memStream.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the bounded report stream used by memTracker. Report
+* text is formatted into a fixed size buffer which is written to a file
+* descriptor each time it fills, so reports of any length need no heap
+* memory and no stdio.
+*
+* Notes:
+*  (1) All stream functions are async-signal-safe.
+*  (2) Not compiled when tracking is off.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*************************************************************************/
+#ifndef _MEM_STREAM_H_
+#define _MEM_STREAM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memLevel.h"
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// Size of a report chunk, and the longest single report line.
+#define MEMSTREAM_CHUNK    4096
+#define MEMSTREAM_LINE_MAX 256
+
+// Report output stream.
+typedef struct MEMSTREAM {
+	int fd;                       // Destination file descriptor.
+	size_t length;                // Bytes pending in buffer.
+	char buffer[MEMSTREAM_CHUNK]; // Pending output.
+} memstream;
+
+void streamOpen(memstream *, int);
+void streamPuts(memstream *, const char *);
+void streamUnsigned(memstream *, uint64_t);
+void streamHex(memstream *, uintptr_t);
+void streamFlush(memstream *);
+bool streamFull(const memstream *);
+
+#endif
+
+#endif
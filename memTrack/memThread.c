@@ -0,0 +1,295 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memThread.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file keeps allocation counters per thread. A thread is given a slot
+* on its first allocation and the slot index is kept in thread local
+* storage. Every block records the slot of the thread which allocated it,
+* so a free from another thread is counted in the cross-thread matrix
+* (freeing thread by allocating thread). A thread only writes its own slot
+* and its own row of the matrix, so no shared word is written on the hot
+* path. Each slot keeps the peak of its own thread's net allocation, and
+* the slots are only combined when counters are read.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Not compiled when tracking is off.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Peak raised before live memory falls, not periodically. JME
+*   10/19/2026: Added threadBytes(). JME
+*   10/19/2026: Per-thread peaks, slots only written by their own thread. JME
+*************************************************************************/
+#include <string.h>
+#include "memTrack.h"
+#include "memThread.h"
+#include "memPlatform.h"
+
+// Nothing is compiled when tracking is off.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// Counters for one thread, padded to a cache line. Only written by their
+// own thread, except for the shared last slot, and read for reports.
+typedef struct THREADSLOT {
+	uint64_t id;             // Operating system thread identifier.
+	uint64_t allocations;    // Allocations made by this thread.
+	uint64_t frees;          // Frees made by this thread.
+	uint64_t allocatedBytes; // Bytes allocated or grown by this thread.
+	uint64_t freedBytes;     // Bytes freed or shrunk by this thread (of any thread's blocks).
+	uint64_t peakBytes;      // Highest allocatedBytes - freedBytes.
+	uint64_t pad[2];
+} threadslot;
+
+// Changes of one thread's blocks by another thread.
+typedef struct CROSSFREE {
+	uint64_t count;      // Frees.
+	uint64_t bytes;      // Bytes freed or shrunk.
+	uint64_t grownBytes; // Bytes grown.
+} crossfree;
+
+static threadslot threadSlots[MEMTRACK_MAX_THREADS];
+static crossfree crossFrees[MEMTRACK_MAX_THREADS][MEMTRACK_MAX_THREADS]; // [freeing][allocating]
+static volatile uint64_t threadCount = 0;
+
+// Slot index of the calling thread, -1 until assigned.
+static MEM_THREAD_LOCAL int32_t threadIndex = -1;
+
+// Live bytes of the other threads, as last summed by the calling thread,
+// and when (ns, 0 if never).
+static MEM_THREAD_LOCAL uint64_t othersBytes = 0;
+static MEM_THREAD_LOCAL uint64_t othersTime = 0;
+
+// Return slot index of the calling thread, assigning one on first use.
+uint32_t threadCurrent(void)
+{
+	if (threadIndex < 0)
+	{
+		uint64_t index = atomicAdd(&threadCount, 1) - 1;
+
+		if (index >= MEMTRACK_MAX_THREADS - 1)
+			index = MEMTRACK_MAX_THREADS - 1;
+		else
+			threadSlots[index].id = threadIdentifier();
+		threadIndex = (int32_t)index;
+	}
+
+	return (uint32_t)threadIndex;
+}
+
+// Add to a counter of the calling thread's slot or matrix row. Only the
+// shared last slot has more than one writer.
+static inline void slotAdd(uint32_t index, volatile uint64_t *p, uint64_t value)
+{
+	if (index == MEMTRACK_MAX_THREADS - 1)
+		atomicAdd(p, value);
+	else
+		atomicStore(p, *p + value);
+}
+
+// Raise the calling thread's peak to its net allocation.
+static inline void slotPeak(uint32_t index)
+{
+	threadslot *pts = &threadSlots[index];
+	uint64_t net = pts->allocatedBytes - pts->freedBytes;
+	uint64_t peak = pts->peakBytes;
+
+	if ((int64_t)net <= (int64_t)peak)
+		return;
+	if (index != MEMTRACK_MAX_THREADS - 1)
+		atomicStore(&pts->peakBytes, net);
+	else
+		while ((int64_t)net > (int64_t)peak && !atomicCompareSwap(&pts->peakBytes, peak, net))
+			peak = atomicLoad(&pts->peakBytes);
+}
+
+// Bytes currently allocated, summed over all threads.
+size_t threadLiveBytes(void)
+{
+	uint64_t count = atomicLoad(&threadCount);
+	uint64_t live = 0;
+
+	if (count > MEMTRACK_MAX_THREADS)
+		count = MEMTRACK_MAX_THREADS;
+	for (uint32_t i = 0; i < count; i++)
+		live += atomicLoad(&threadSlots[i].allocatedBytes) - atomicLoad(&threadSlots[i].freedBytes);
+
+	return (size_t)live;
+}
+
+// Estimate bytes currently allocated, for checks made too often to sum
+// all slots: the calling thread's own share is exact, the other threads'
+// is summed at most every MEMTRACK_LIVE_REFRESH_MS. Only reads shared
+// words, and only the calling thread's slot on most calls.
+size_t threadLiveEstimate(uint64_t now)
+{
+	uint32_t index = threadCurrent();
+	uint64_t own = atomicLoad(&threadSlots[index].allocatedBytes) - atomicLoad(&threadSlots[index].freedBytes);
+
+	if (othersTime == 0 || now - othersTime >= MEMTRACK_LIVE_REFRESH_MS * 1000000ull)
+	{
+		othersBytes = (uint64_t)threadLiveBytes() - own;
+		othersTime = now ? now : 1;
+	}
+
+	return (size_t)(own + othersBytes);
+}
+
+// Count an allocation by the calling thread (slot index from threadCurrent).
+void threadAllocated(uint32_t index, size_t size)
+{
+	threadslot *pts = &threadSlots[index];
+
+	slotAdd(index, &pts->allocations, 1);
+	slotAdd(index, &pts->allocatedBytes, size);
+	slotPeak(index);
+}
+
+// Count a free by the calling thread of a block allocated by owner.
+void threadFreed(uint32_t owner, size_t size)
+{
+	uint32_t index = threadCurrent();
+
+	slotAdd(index, &threadSlots[index].frees, 1);
+	slotAdd(index, &threadSlots[index].freedBytes, size);
+
+	if (owner != index)
+	{
+		slotAdd(index, &crossFrees[index][owner].count, 1);
+		slotAdd(index, &crossFrees[index][owner].bytes, size);
+	}
+}
+
+// Count a change of size by the calling thread of a block allocated by owner.
+void threadResized(uint32_t owner, size_t sizeOld, size_t sizeNew)
+{
+	uint32_t index = threadCurrent();
+
+	if (sizeNew > sizeOld)
+	{
+		slotAdd(index, &threadSlots[index].allocatedBytes, sizeNew - sizeOld);
+		slotPeak(index);
+		if (owner != index)
+			slotAdd(index, &crossFrees[index][owner].grownBytes, sizeNew - sizeOld);
+	}
+	else if (sizeNew < sizeOld)
+	{
+		slotAdd(index, &threadSlots[index].freedBytes, sizeOld - sizeNew);
+		if (owner != index)
+			slotAdd(index, &crossFrees[index][owner].bytes, sizeOld - sizeNew);
+	}
+}
+
+// Sum the counters of all threads. The peak is the sum of the per-thread
+// peaks, so is never below the true peak, and equal to it when a single
+// thread allocates.
+void threadCounters(memcounters *pCounters)
+{
+	memset(pCounters, 0, sizeof(memcounters));
+
+	for (uint32_t i = 0; i < MEMTRACK_MAX_THREADS; i++)
+	{
+		pCounters->allocations += atomicLoad(&threadSlots[i].allocations);
+		pCounters->frees += atomicLoad(&threadSlots[i].frees);
+		pCounters->peakBytes += atomicLoad(&threadSlots[i].peakBytes);
+	}
+	pCounters->liveBytes = threadLiveBytes();
+
+	// Slots read at different times may sum below the live total.
+	if (pCounters->liveBytes > pCounters->peakBytes)
+		pCounters->peakBytes = pCounters->liveBytes;
+}
+
+// Return live bytes of the blocks allocated by a thread, whichever thread
+// freed or resized them.
+static uint64_t threadOwnedBytes(uint32_t owner, uint32_t count)
+{
+	uint64_t live = atomicLoad(&threadSlots[owner].allocatedBytes) - atomicLoad(&threadSlots[owner].freedBytes);
+
+	for (uint32_t i = 0; i < count; i++)
+	{
+		if (i == owner)
+			continue;
+
+		// Undo the owner's changes of other threads' blocks, and apply
+		// other threads' changes of the owner's blocks.
+		live += atomicLoad(&crossFrees[owner][i].bytes) - atomicLoad(&crossFrees[owner][i].grownBytes);
+		live -= atomicLoad(&crossFrees[i][owner].bytes) - atomicLoad(&crossFrees[i][owner].grownBytes);
+	}
+
+	return live;
+}
+
+// Return bytes held by the thread slots and cross-thread matrix.
+size_t threadBytes(void)
+{
+	return sizeof(threadSlots) + sizeof(crossFrees);
+}
+
+// Stream per-thread counters and the cross-thread free matrix. Nothing is
+// written for a single threaded program.
+void streamThreads(memstream *ms)
+{
+	uint32_t count = (uint32_t)atomicLoad(&threadCount);
+	bool heading = false;
+
+	if (count < 2)
+		return;
+	if (count > MEMTRACK_MAX_THREADS)
+		count = MEMTRACK_MAX_THREADS;
+
+	streamPuts(ms, "\nThreads:\n");
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const threadslot *pts = &threadSlots[i];
+
+		streamPuts(ms, "#");
+		streamUnsigned(ms, i);
+		if (i == MEMTRACK_MAX_THREADS - 1)
+			streamPuts(ms, " (other threads)");
+		else
+		{
+			streamPuts(ms, " (id ");
+			streamUnsigned(ms, pts->id);
+			streamPuts(ms, ")");
+		}
+		streamPuts(ms, " allocs: ");
+		streamUnsigned(ms, atomicLoad(&threadSlots[i].allocations));
+		streamPuts(ms, " frees: ");
+		streamUnsigned(ms, atomicLoad(&threadSlots[i].frees));
+		streamPuts(ms, " live: ");
+		streamUnsigned(ms, threadOwnedBytes(i, count));
+		streamPuts(ms, " bytes\n");
+	}
+
+	// Only the non-zero cells of the matrix.
+	for (uint32_t i = 0; i < count; i++)
+		for (uint32_t j = 0; j < count; j++)
+		{
+			uint64_t n = atomicLoad(&crossFrees[i][j].count);
+
+			if (n == 0)
+				continue;
+			if (!heading)
+			{
+				streamPuts(ms, "\nCross-thread frees (freed by <- allocated by):\n");
+				heading = true;
+			}
+
+			streamPuts(ms, "#");
+			streamUnsigned(ms, i);
+			streamPuts(ms, " <- #");
+			streamUnsigned(ms, j);
+			streamPuts(ms, " frees: ");
+			streamUnsigned(ms, n);
+			streamPuts(ms, " bytes: ");
+			streamUnsigned(ms, atomicLoad(&crossFrees[i][j].bytes));
+			streamPuts(ms, "\n");
+		}
+}
+
+#endif
@@ -0,0 +1,58 @@
+/*************************************************************************
+* Title: memTracker
+* File: memThread.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the per-thread allocation accounting of memTracker.
+* Each thread gets a small index and a slot of counters, and frees of
+* blocks allocated by another thread are counted in a cross-thread matrix.
+*
+* Notes:
+*  (1) Lock free, may be called with or without the tracker lock held.
+*  (2) Not compiled when tracking is off.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: At most 4096 thread slots (see memStore.h). JME
+*   10/19/2026: Peak raised before live memory falls, not periodically. JME
+*   10/19/2026: Added threadBytes(). JME
+*   10/19/2026: Removed threadFlush(), peaks are kept per thread. JME
+*   10/19/2026: Added threadLiveEstimate(). JME
+*************************************************************************/
+#ifndef _MEM_THREAD_H_
+#define _MEM_THREAD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "memTrack.h"
+#include "memStream.h"
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// Number of thread slots (at most 4096). Threads beyond this share the
+// last slot.
+#ifndef MEMTRACK_MAX_THREADS
+#define MEMTRACK_MAX_THREADS 64
+#endif
+
+// Interval at which threadLiveEstimate() sums the other threads' live
+// bytes (ms).
+#ifndef MEMTRACK_LIVE_REFRESH_MS
+#define MEMTRACK_LIVE_REFRESH_MS 1
+#endif
+
+uint32_t threadCurrent(void);
+void threadAllocated(uint32_t, size_t);
+void threadFreed(uint32_t, size_t);
+void threadResized(uint32_t, size_t, size_t);
+void threadCounters(memcounters *);
+size_t threadBytes(void);
+size_t threadLiveBytes(void);
+size_t threadLiveEstimate(uint64_t);
+void streamThreads(memstream *);
+
+#endif
+
+#endif
@@ -9,213 +9,1130 @@
 * __Exit functions intercept the user's calls to the respective system 
 * functions (via replacement by macros inside memTracker.h). The remaining 
 * functions below are used to track the user's memory allocations using the 
-* very simple BLOCKINFO linked-list structure.
+* block record store (see memStore.h).
 *
 * Notes:
 *  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
 *      language options.
-*  (2) Not compiled in release version.
+*  (2) Only the code needed by MEMTRACK_LEVEL is compiled (see memLevel.h),
+*      nothing is compiled when tracking is off.
 *  (3) Released into the public domain.
 *************************************************************************
 * Change Log:
 *   11/13/2017: Initial release. JME
+*   10/19/2026: Report at exit via atexit(), on abort and on request (signal
+*               or requestReport) through a reporter thread. Reports are
+*               streamed to a descriptor in bounded chunks. JME
+*   10/19/2026: Timestamp allocations, profile lifetimes per site and
+*               sample a timeline of total memory. JME
+*   10/19/2026: Compile-time tracking levels (counters, sampled, full). JME
+*   10/19/2026: Per-thread accounting and cross-thread free matrix. JME
+*   10/19/2026: Optional size-class arena backend (MEMTRACK_ARENA). JME
+*   10/19/2026: Block records kept in a structure-of-arrays store, found
+*               through the record index in the block header. JME
+*   10/19/2026: Exit verification split across a worker pool. JME
+*   10/19/2026: Batched span validation by merge join. JME
+*   10/19/2026: Heap captures on crossing total or site watermarks. JME
+*   10/19/2026: Overhead and fragmentation accounting in reports. JME
+*   10/19/2026: Blocks are only counted once the exit check has run. JME
+*   10/19/2026: Samples are taken at random gaps. JME
+*   10/19/2026: Overhead totals kept as blocks change. JME
+*   10/19/2026: Block headers checked against the records before use. JME
+*   10/19/2026: Added waitForReport(). JME
 *************************************************************************/
 #include "memTrack.h"
 
-// This is only compiled in debug version.
-#ifdef _DEBUG
+// Nothing is compiled when tracking is off.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+#include <signal.h>
+#include "memPlatform.h"
+#include "memStream.h"
+#include "memThread.h"
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+#include "memProfile.h"
+#include "memStore.h"
+#include "memArena.h"
+#include "memVerify.h"
+#include "memWatch.h"
+#include "memAccount.h"
+#endif
 
-// Pointer to head of memory blockinfo list.
-static blockinfo *pbiHead = NULL;
+// Signal requesting an on-demand report (define as 0 to disable).
+#if !defined(MEMTRACK_REPORT_SIGNAL) && defined(SIGUSR1)
+#define MEMTRACK_REPORT_SIGNAL SIGUSR1
+#endif
 
-// Check and designate pointer as free.
-bool setMemoryStatus(const void *pMem) 
+// Tracker state.
+static volatile uint64_t trackerInitialized = 0; // Exit/abort hooks installed.
+static volatile sig_atomic_t reporterReady = 0;  // Reporter thread is waiting for requests.
+static volatile int reportFd = MEM_STDERR_FD;    // Descriptor receiving reports.
+static memsemaphore reportRequest;               // Posted to wake the reporter thread.
+static memsemaphore reportWritten;               // Posted as the reporter writes each report.
+static volatile uint64_t reportsRequested = 0;   // Reports requested of the reporter.
+static volatile uint64_t reportsWritten = 0;     // Reports it has written.
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Serializes all access to the block records and memory totals.
+static memlock trackerLock = MEM_LOCK_INIT;
+
+// Exit check has run, blocks are only counted from then on.
+static bool shuttingDown = false;
+
+// Records total memory allocations.
+static size_t totalMemory = 0;
+
+// Internal function definitions.
+static bool setMemoryStatus(const uint32_t);
+static uint32_t createBlockInfo(uint8_t *, const size_t, const unsigned char, const uint32_t, const uint32_t, const uint64_t);
+static void updateBlockInfo(const uint32_t, uint8_t *, const size_t, const unsigned char);
+static uint32_t findBlock(const uint8_t *);
+static uint32_t getBlockInfo(const uint8_t *);
+static void checkAllocations(memstream *);
+static void *resizeMemory(void **, size_t, char *, int);
+static void sampleTimeline(uint64_t);
+
+// Check and designate block as free.
+static bool setMemoryStatus(const uint32_t index) 
 {
-	blockinfo *pbi;
-
-	pbi = getBlockInfo((uint8_t *)pMem);
-
-	if (pbi->status & BLOCK_STATUS_FREE)
+	if (blocks.tag[index] & BLOCK_STATUS_FREE)
 		return false;
-	pbi->status |= BLOCK_STATUS_FREE;
+	blocks.tag[index] |= BLOCK_STATUS_FREE;
 	
 	return true;
 }
 
-// Check and designate pointer as free.
-static unsigned char getBlockStatus(const void *pMem) 
+// Create a new block record for memory pointer, returning its index.
+static uint32_t createBlockInfo(uint8_t *pMem, const size_t size, const unsigned char status, const uint32_t thread, const uint32_t site, const uint64_t time) 
 {
-	blockinfo *pbi;
+	uint32_t index;
 
-	pbi = getBlockInfo((uint8_t *)pMem);
-	
-	if (pbi != NULL)
-		return pbi->status;
-	return 0;
+	assert(pMem != NULL && size != 0);
+
+	index = storeCreate(pMem, size, TAG_MAKE(status, thread, site), STORE_TIME(time));
+	if (index != BLOCK_NONE)
+		accountAdd(index);
+
+	return index;
 }
 
-// Create a new blockinfo list entry for memory pointer.
-static bool createBlockInfo(uint8_t *pMem, const size_t size, const unsigned char status) 
+// Return index of the block record corresponding to memory pointer, or
+// BLOCK_NONE for a counted block (or an arena slot no longer in use).
+static uint32_t findBlock(const uint8_t *pMem) 
 {
-	assert(pMem != NULL && size != 0);
+	uint64_t header;
+	uint32_t index;
 
-	// Reserve memory for new blockinfo list entry.
-	blockinfo *pbi = (blockinfo *)malloc(sizeof(blockinfo));
+	assert(pMem != NULL);
 
-	// Fill structure.
-	if (pbi != NULL) 
-	{
-		pbi->pMem = pMem;
-		pbi->size = size;
-		pbi->status = status;
-		pbi->pbiNext = pbiHead;
-		pbiHead = pbi;
-	}
+#ifdef MEMTRACK_ARENA
+	// Arena blocks are found directly from their address.
+	if (arenaContains(pMem))
+		return arenaRecord(pMem);
+#endif
+
+	// The header is trusted only if its record points back at the block.
+	header = *HEADER_OF(pMem);
+	index = HEADER_INDEX(header);
+	if ((header & HEADER_TRACKED) && index < blocks.count && blocks.pMem[index] == pMem)
+		return index;
 
-	// Return status.
-	return (bool)(pbi != NULL);
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	// Unsampled blocks are only counted.
+	if (!(header & HEADER_TRACKED))
+		return BLOCK_NONE;
+#endif
+
+	// Overwritten by an under-run, or a counted block at the full level.
+	return storeFind(pMem);
 }
 
-// Return blockinfo list element corresponding to memory pointer.
-static blockinfo *getBlockInfo(const uint8_t *pMem) 
+// Return index of the block record of a tracked memory pointer.
+static uint32_t getBlockInfo(const uint8_t *pMem) 
 {
-	blockinfo *pbi;
+	uint32_t index = findBlock(pMem);
 
-	assert(pMem != NULL);
+	assert(index != BLOCK_NONE);
+
+	return index;
+}
+
+// Update block record after a realloc.
+static void updateBlockInfo(const uint32_t index, uint8_t *pNew, const size_t sizeNew, const unsigned char status) 
+{
+	assert(pNew != NULL && sizeNew != 0);
+
+	storeSetMemory(index, pNew);
+	blocks.tag[index] |= status;
+	storeSetSize(index, sizeNew);
+}
+
+// Return size of memory block associated with pointer.
+size_t sizeOfBlock(const uint8_t *pMem) 
+{
+	uint32_t index = getBlockInfo(pMem);
+	assert(pMem == blocks.pMem[index]);
+	return storeSize(index);
+}
 
-	// Walk blockinfo list looking for match.
-	for (pbi = pbiHead; pbi != NULL; pbi = pbi->pbiNext) 
+#endif
+
+// Return a snapshot of the allocation counters.
+void getAllocationCounters(memcounters *pCounters)
+{
+	threadCounters(pCounters);
+}
+
+// Append the allocation counters.
+static void streamCounters(memstream *ms)
+{
+	memcounters snapshot;
+
+	getAllocationCounters(&snapshot);
+
+	streamPuts(ms, "Allocations: ");
+	streamUnsigned(ms, snapshot.allocations);
+	streamPuts(ms, " frees: ");
+	streamUnsigned(ms, snapshot.frees);
+	streamPuts(ms, " live: ");
+	streamUnsigned(ms, snapshot.liveBytes);
+	streamPuts(ms, " bytes peak: ");
+	streamUnsigned(ms, snapshot.peakBytes);
+	streamPuts(ms, " bytes\n");
+
+	// Per-thread counters, if more than one thread allocated.
+	streamThreads(ms);
+}
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Append one report line describing a block record.
+static void streamBlockInfo(memstream *ms, const uint32_t index)
+{
+	// Block status descriptions.
+	static const char *blockStatus[MAX_STATUS_BITS] = { "malloc ", "calloc ", "realloc ", "free " };
+
+	streamHex(ms, (uintptr_t)blocks.pMem[index]);
+	streamPuts(ms, " size: ");
+	streamUnsigned(ms, storeSize(index));
+	streamPuts(ms, " [ ");
+
+	// Check all status bits.
+	for (uint8_t i = 0; i < MAX_STATUS_BITS; i++)
+		if (blocks.tag[index] & (1 << i))
+			streamPuts(ms, blockStatus[i]);
+	streamPuts(ms, "]\n");
+}
+
+// Stream a table through a formatter, one chunk at a time under the lock.
+static void streamChunked(memstream *ms, bool (*format)(memstream *, size_t *)) 
+{
+	size_t cursor = 0;
+	bool done = false;
+
+	while (!done) 
 	{
-		uint8_t *pbStart = pbi->pMem;
-		uint8_t *pbEnd = pbi->pMem + pbi->size - 1;
-		if (pMem >= pbStart && pMem <= pbEnd)
-			break;
+		lockAcquire(&trackerLock);
+		done = format(ms, &cursor);
+		lockRelease(&trackerLock);
+
+		streamFlush(ms);
 	}
+}
 
-	assert(pbi != NULL);
+// Stream block records from cursor until the chunk fills. Returns true when done.
+static bool streamBlocks(memstream *ms, size_t *cursor)
+{
+	for (; !shuttingDown && *cursor < blocks.count; (*cursor)++)
+	{
+		if (streamFull(ms))
+			return false;
+
+		// Skip released records.
+		if (blocks.tag[*cursor] != 0)
+			streamBlockInfo(ms, (uint32_t)*cursor);
+	}
 
-	return (pbi);
+	return true;
 }
 
-// Update blockinfo entry for the memory pointer.
-static void updateBlockInfo(const uint8_t *pOld, uint8_t *pNew, const size_t sizeNew, const unsigned char status) 
+// Stream report of _all_ memory allocations to a descriptor.
+void reportAllocationsTo(int fd) 
 {
-	assert(pNew != NULL && sizeNew != 0);
+	memstream ms;
+
+	streamOpen(&ms, fd);
+	streamCounters(&ms);
+
+	lockAcquire(&trackerLock);
+	streamOverhead(&ms);
+	lockRelease(&trackerLock);
+
+	streamChunked(&ms, streamBlocks);
+}
+
+// Stream allocation site profile, pooling candidates and memory timeline to a descriptor.
+void reportProfileTo(int fd) 
+{
+	memstream ms;
+
+	streamOpen(&ms, fd);
+
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	streamPuts(&ms, "\nAllocation sites (1 in ");
+	streamUnsigned(&ms, MEMTRACK_SAMPLE_RATE);
+	streamPuts(&ms, " sampled):\n");
+#else
+	streamPuts(&ms, "\nAllocation sites:\n");
+#endif
+	streamChunked(&ms, streamSites);
 
-	blockinfo *pbi = getBlockInfo(pOld);
-	assert(pOld == pbi->pMem);
-	pbi->pMem = pNew;
-	pbi->size = sizeNew;
-	pbi->status |= status;
+	lockAcquire(&trackerLock);
+	streamPoolCandidates(&ms);
+	lockRelease(&trackerLock);
+
+	streamPuts(&ms, "\nTimeline:\n");
+	streamChunked(&ms, streamTimeline);
+}
+
+// Print allocation profile.
+void reportProfile(void) 
+{
+	reportProfileTo(reportFd);
 }
 
-// Release the blockinfo entry for the memory pointer.
-static void freeBlockInfo(const uint8_t *pMem) 
+// Set the memory timeline sample interval.
+void setTimelineInterval(unsigned int milliseconds) 
 {
-	blockinfo *pbi, *pbiPrev = NULL;
+	lockAcquire(&trackerLock);
+	timelineSetInterval((uint64_t)milliseconds * 1000000u);
+	lockRelease(&trackerLock);
+}
+
+// Return the breakdown of memory behind the tracked blocks.
+void getMemoryOverhead(memoverhead *pOverhead) 
+{
+	lockAcquire(&trackerLock);
+	accountMemory(pOverhead);
+	lockRelease(&trackerLock);
+}
+
+// Capture the heap when total live memory rises above bytes (0 for never).
+void setWatermark(size_t bytes) 
+{
+	lockAcquire(&trackerLock);
+	watermarkSet(bytes);
+	lockRelease(&trackerLock);
+}
+
+// Capture the heap when the live memory of any site rises above bytes (0 for never).
+void setSiteWatermark(size_t bytes) 
+{
+	lockAcquire(&trackerLock);
+	watermarkSetSite(bytes);
+	lockRelease(&trackerLock);
+}
+
+// Span query, sorted by address for the join.
+typedef struct SPANQUERY {
+	uintptr_t address;
+	size_t span;
+} spanquery;
+
+// A stale sorted view is only rebuilt for this many spans per 1 in
+// SPAN_SORT_RATIO records, fewer spans are found by one walk of the records.
+#define SPAN_SORT_RATIO 8
+
+// Order span queries by address.
+static int compareQueries(const void *a, const void *b)
+{
+	uintptr_t pa = ((const spanquery *)a)->address;
+	uintptr_t pb = ((const spanquery *)b)->address;
+
+	return (pa > pb) - (pa < pb);
+}
+
+// Status of a span starting within a block, SPAN_UNKNOWN if it does not.
+static unsigned char spanStatus(const uint32_t index, uintptr_t address, size_t size)
+{
+	size_t offset = address - (uintptr_t)blocks.pMem[index];
+	size_t sizeBlock = storeSize(index);
+
+	if (address < (uintptr_t)blocks.pMem[index] || offset >= sizeBlock)
+		return SPAN_UNKNOWN;
+	if (CHECK_BLOCK_FREE(blocks.tag[index]))
+		return SPAN_FREED;
+	if (size > sizeBlock - offset)
+		return SPAN_OVERRUN;
+
+	return SPAN_VALID;
+}
 
-	// Walk the blockinfo list looking for match.
-	for (pbi = pbiHead; pbi != NULL; pbi = pbi->pbiNext) 
+// Join the sorted queries with the address ordered view of the blocks,
+// binary searching the view when it is much longer. Blocks never overlap.
+static void spansByView(const spanquery *queries, size_t count, const memspan *pSpans, const uint32_t *order, uint32_t blockCount, unsigned char *status)
+{
+	bool search = (bool)(blockCount / SPAN_SORT_RATIO > count);
+
+	for (size_t i = 0, j = 0; i < count; i++)
+	{
+		uintptr_t address = queries[i].address;
+
+		// Find last block starting at or below the span.
+		if (search)
+		{
+			size_t lo = j, hi = blockCount;
+
+			while (hi - lo > 1)
+			{
+				size_t mid = lo + (hi - lo) / 2;
+
+				if ((uintptr_t)blocks.pMem[order[mid]] <= address)
+					lo = mid;
+				else
+					hi = mid;
+			}
+			j = lo;
+		}
+		else
+			while (j + 1 < blockCount && (uintptr_t)blocks.pMem[order[j + 1]] <= address)
+				j++;
+
+		if (blockCount)
+			status[queries[i].span] = spanStatus(order[j], address, pSpans[queries[i].span].size);
+	}
+}
+
+// Walk the records once, finding the sorted queries within each block.
+static void spansByWalk(const spanquery *queries, size_t count, const memspan *pSpans, unsigned char *status)
+{
+	for (uint32_t r = 0; r < blocks.count; r++)
 	{
-		if (pbi->pMem == pMem) 
+		uintptr_t start = (uintptr_t)blocks.pMem[r];
+		size_t sizeBlock, lo = 0, hi = count;
+
+		if (blocks.tag[r] == 0)
+			continue;
+		sizeBlock = storeSize(r);
+
+		// First query at or above the block.
+		while (lo < hi)
 		{
-			// Matched a block, update links.
-			if (pbiPrev == NULL)
-				pbiHead = pbi->pbiNext;
+			size_t mid = lo + (hi - lo) / 2;
+
+			if (queries[mid].address < start)
+				lo = mid + 1;
 			else
-				pbiPrev->pbiNext = pbi->pbiNext;
-			break;
+				hi = mid;
 		}
 
-		pbiPrev = pbi;
+		for (; lo < count && queries[lo].address - start < sizeBlock; lo++)
+			status[queries[lo].span] = spanStatus(r, queries[lo].address, pSpans[queries[lo].span].size);
 	}
+}
 
- 	assert(pbi != NULL);
-	
-	// Annotate blockinfo memory as dead.
-	memset(pbi, _deadLandFill, sizeof(blockinfo));
-	
-	// Free the memory for this blockinfo list entry.
-	free(pbi);
+// Validate an array of spans against the tracked blocks. Bit i of the
+// bitmap, (count + 7) / 8 bytes long, is set if span i is invalid, and the
+// first maxErrors invalid spans are listed in span order. Either output may be
+// NULL. Returns number of invalid spans, or SIZE_MAX if out of memory.
+size_t validateSpans(const memspan *pSpans, size_t count, uint8_t *pInvalid, memspanerror *pErrors, size_t maxErrors)
+{
+	spanquery *queries;
+	unsigned char *status;
+	const uint32_t *order;
+	uint32_t blockCount = 0;
+	size_t invalid = 0;
+
+	assert(pSpans != NULL || count == 0);
+
+	queries = (spanquery *)malloc((count ? count : 1) * sizeof(spanquery));
+	status = (unsigned char *)malloc(count ? count : 1);
+	if (queries == NULL || status == NULL)
+	{
+		free(queries);
+		free(status);
+		return SIZE_MAX;
+	}
+
+	// Sort the queries outside the lock.
+	for (size_t i = 0; i < count; i++)
+	{
+		queries[i].address = (uintptr_t)pSpans[i].pMem;
+		queries[i].span = i;
+		status[i] = SPAN_UNKNOWN;
+	}
+	qsort(queries, count, sizeof(spanquery), compareQueries);
+
+	lockAcquire(&trackerLock);
+
+	// The sorted view is kept until blocks are created, released or moved.
+	// A stale view is only worth sorting again for many spans.
+	if (!storeSortedCurrent() && count < blocks.count / SPAN_SORT_RATIO)
+		spansByWalk(queries, count, pSpans, status);
+	else if ((order = storeSorted(&blockCount)) != NULL)
+		spansByView(queries, count, pSpans, order, blockCount, status);
+	else
+	{
+		lockRelease(&trackerLock);
+		free(queries);
+		free(status);
+		return SIZE_MAX;
+	}
+
+	lockRelease(&trackerLock);
+
+	// Results in span order.
+	if (pInvalid != NULL)
+		memset(pInvalid, 0, (count + 7) / 8);
+	for (size_t i = 0; i < count; i++)
+	{
+		if (pSpans[i].pMem == NULL || pSpans[i].size == 0)
+			status[i] = SPAN_INVALID;
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+		// Untracked blocks can't be checked.
+		else if (status[i] == SPAN_UNKNOWN)
+			status[i] = SPAN_VALID;
+#endif
+
+		if (status[i] != SPAN_VALID)
+		{
+			if (pInvalid != NULL)
+				pInvalid[i / 8] |= (uint8_t)(1u << (i % 8));
+			if (pErrors != NULL && invalid < maxErrors)
+			{
+				pErrors[invalid].span = i;
+				pErrors[invalid].status = status[i];
+			}
+			invalid++;
+		}
+	}
+
+	free(queries);
+	free(status);
+
+	return invalid;
 }
 
-// Return size of memory block associated with pointer.
-size_t sizeOfBlock(const uint8_t *pMem) 
+#else
+
+// Stream allocation counters to a descriptor.
+void reportAllocationsTo(int fd)
 {
-	blockinfo *pbi = getBlockInfo(pMem);
-	assert(pMem == pbi->pMem);
-	return (pbi->size);
+	memstream ms;
+
+	streamOpen(&ms, fd);
+	streamCounters(&ms);
+	streamFlush(&ms);
 }
 
+#endif
+
 // Print report of _all_ memory allocations.
-void reportAllocations(void) 
+void reportAllocations(void)
+{
+	reportAllocationsTo(reportFd);
+}
+
+// Redirect reports to a descriptor (stderr by default).
+void setReportDescriptor(int fd) 
 {
-	blockinfo *pbi = pbiHead;
+	reportFd = fd;
+}
 
-	while (pbi != NULL) 
+// Ask the reporter thread for a report. Async-signal-safe.
+void requestReport(void) 
+{
+	if (reporterReady)
 	{
-		blockinfo *next = pbi->pbiNext;
+		atomicAdd(&reportsRequested, 1);
+		semaphorePost(&reportRequest);
+	}
+}
 
-		if (pbi->pMem != NULL) 
-		{
-			// Block status descriptions.
-			char *blockStatus[4] = { "malloc ", "calloc ", "realloc ", "free " };
-
-			fprintf(stderr, "0x%X size: %d", (unsigned int)pbi->pMem, pbi->size);
-			fputs(" [ ", stderr);
-			
-			// Check all status bits.
-			for (uint8_t i = 0; i < MAX_STATUS_BITS; i++)
-				if (pbi->status & (1 << i))
-					fputs(blockStatus[i], stderr);
-			fputs("]\n", stderr);
-
-			pbi = next;
-		}
+// Wait up to milliseconds for the requested reports to be written. Returns
+// false if one is still pending.
+bool waitForReport(unsigned int milliseconds)
+{
+	uint64_t requested = atomicLoad(&reportsRequested);
+
+	while (atomicLoad(&reportsWritten) < requested)
+		if (!semaphoreWaitFor(&reportWritten, (uint64_t)milliseconds * 1000000u))
+			return false;
+
+	return true;
+}
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Check _all_ released memory for invalid access. Called with the lock held.
+static void checkAllocations(memstream *ms)
+{
+	// Check and release the blocks on a pool of workers.
+	verifyBlocks(ms);
+
+	// List sites which would benefit from pooling.
+	streamPoolCandidates(ms);
+}
+
+#endif
+
+// Final check, registered with atexit() so it also runs on return from main().
+static void exitHandler(void) 
+{
+	memstream ms;
+
+	// Stop further reports.
+	reporterReady = 0;
+
+	streamOpen(&ms, reportFd);
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+	lockAcquire(&trackerLock);
+
+	// The records are about to be released.
+	shuttingDown = true;
+	checkAllocations(&ms);
+
+	lockRelease(&trackerLock);
+#endif
+
+	// Report if all memory released.
+	streamPuts(&ms, "\n");
+	streamCounters(&ms);
+	if (threadLiveBytes() == 0)
+		streamPuts(&ms, "All memory de-allocated.\n");
+
+	streamFlush(&ms);
+}
+
+// Dump live allocations on abort (e.g. a failed assert). The lock may be
+// held by the aborting thread, so the records are walked without it.
+static void abortHandler(int sig) 
+{
+	memstream ms;
+
+	streamOpen(&ms, reportFd);
+	streamPuts(&ms, "\n*** memTracker: abort.\n");
+	streamCounters(&ms);
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+	if (!shuttingDown) 
+	{
+		streamPuts(&ms, "Allocations follow.\n");
+
+		for (uint32_t i = 0; i < blocks.count; i++)
+			if (blocks.tag[i] != 0)
+				streamBlockInfo(&ms, i);
+	}
+#endif
+
+	streamFlush(&ms);
+
+	// Continue with the program's abort handler, or the default abort.
+	signalRestore(sig);
+	raise(sig);
+}
+
+#if MEMTRACK_REPORT_SIGNAL
+// Report signal handler, hands the request to the reporter thread.
+static void reportSignalHandler(int sig) 
+{
+	(void)sig;
+	requestReport();
+}
+#endif
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Shortest wait between timeline samples taken by the reporter (ns).
+#define REPORTER_MIN_WAIT 1000000u
+
+// Sample the timeline if due, returning the time until the next sample.
+static uint64_t timelineIdle(void)
+{
+	uint64_t now = clockNanoseconds();
+	uint64_t wait;
+
+	lockAcquire(&trackerLock);
+	sampleTimeline(now);
+	wait = timelineWait(now);
+	lockRelease(&trackerLock);
+
+	return wait > REPORTER_MIN_WAIT ? wait : REPORTER_MIN_WAIT;
+}
+
+#endif
+
+// Reporter thread, streams a report for each request. Between requests it
+// samples the timeline, which allocations alone stop doing when idle.
+static void reporterThread(void *arg) 
+{
+	(void)arg;
+
+	for (;;) 
+	{
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+		while (!semaphoreWaitFor(&reportRequest, timelineIdle()))
+			if (!reporterReady)
+				return;
+#else
+		semaphoreWait(&reportRequest);
+#endif
+		if (!reporterReady)
+			break;
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+		// A heap capture, else a full report.
+		if (watermarkStream(reportFd))
+			continue;
+#endif
+		reportAllocations();
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+		reportProfile();
+#endif
+		atomicAdd(&reportsWritten, 1);
+		semaphorePost(&reportWritten);
 	}
 }
 
-// Check _all_ released memory for invalid access.
-static void checkAllocations(void) 
+// Install the exit and abort hooks and start the reporter.
+static void initTracker(void) 
 {
-	blockinfo *pbi = pbiHead;
+	atexit(exitHandler);
+	signalInstall(SIGABRT, abortHandler, true);
 
-	// Walk the allocated memory blockinfo list.
-	while (pbi != NULL) 
+	if (semaphoreCreate(&reportRequest) && semaphoreCreate(&reportWritten)) 
 	{
-		// First get pointer to next block.
-		blockinfo *next = pbi->pbiNext;
+		reporterReady = 1;
+
+		if (!threadStart(reporterThread, NULL))
+			reporterReady = 0;
+#if MEMTRACK_REPORT_SIGNAL
+		else
+			signalInstall(MEMTRACK_REPORT_SIGNAL, reportSignalHandler, false);
+#endif
+	}
+}
+
+// Initialize on first allocation, exactly once.
+#define INIT_TRACKER() \
+	if (!trackerInitialized && atomicCompareSwap(&trackerInitialized, 0, 1)) \
+		initTracker()
+
+// Counted (untracked) block layout: [header][unused][memory], with
+// HEADER_TRACKED clear in the header. Used below the full tracking level,
+// and by all levels once the exit check has run.
+
+// Allocate an untracked block, counting it.
+static void *countedMalloc(size_t size, char *file, int line)
+{
+	uint8_t *pMem = (uint8_t *)malloc(size + MALLOC_USER_OFFSET);
+
+	if (pMem == NULL)
+	{
+		fprintf(stderr, "*** WARNING: malloc() failure: %s, line #%d\n", file, line);
+		return NULL;
+	}
+
+	uint32_t thread = threadCurrent();
+
+	*(uint64_t *)pMem = HEADER_MAKE(size, thread, 0);
+	threadAllocated(thread, size);
+
+	return pMem + MALLOC_USER_OFFSET;
+}
+
+// True if num*size, with a block's header and padding, overflows a size_t.
+#define CALLOC_OVERFLOW(num, size) ((num) && (size) > (SIZE_MAX - MALLOC_HEADER - MALLOC_PADDING) / (num))
+
+// Allocate a zeroed untracked block, counting it.
+static void *countedCalloc(size_t num, size_t size, char *file, int line)
+{
+	uint8_t *pMem = CALLOC_OVERFLOW(num, size) ? NULL : (uint8_t *)calloc(num*size + MALLOC_USER_OFFSET, 1);
+
+	if (pMem == NULL)
+	{
+		fprintf(stderr, "*** WARNING: calloc() failure: %s, line #%d\n", file, line);
+		return NULL;
+	}
+
+	uint32_t thread = threadCurrent();
+
+	*(uint64_t *)pMem = HEADER_MAKE(num*size, thread, 0);
+	threadAllocated(thread, num*size);
+
+	return pMem + MALLOC_USER_OFFSET;
+}
 
-		// If block exists...
-		if (pbi->pMem != NULL) 
+// Check the header of an untracked block, which an under-run may have
+// overwritten. Its thread indexes the thread slots, so must be in range.
+static bool countedHeader(const void *pMem, uint64_t header)
+{
+	if (!(header & HEADER_TRACKED) && HEADER_THREAD(header) < MEMTRACK_MAX_THREADS)
+		return true;
+
+	fprintf(stderr, "*** WARNING: Memory under-run detected at 0x%p.\n", (void *)HEADER_OF(pMem));
+	return false;
+}
+
+// Resize an untracked block. A block with an overwritten header is taken
+// over by the calling thread, its old size is not known.
+static void *countedRealloc(void *pMem, size_t sizeNew, char *file, int line)
+{
+	uint64_t header = *HEADER_OF(pMem);
+	bool valid = countedHeader(pMem, header);
+	uint32_t thread = valid ? HEADER_THREAD(header) : threadCurrent();
+	uint8_t *pNew = (uint8_t *)realloc(HEADER_OF(pMem), sizeNew + MALLOC_USER_OFFSET);
+
+	if (pNew == NULL)
+	{
+		fprintf(stderr, "*** WARNING: realloc() failure: %s, line #%d\n", file, line);
+		return NULL;
+	}
+
+	*(uint64_t *)pNew = HEADER_MAKE(sizeNew, thread, 0);
+	if (valid)
+		threadResized(thread, HEADER_SIZE(header), sizeNew);
+	else
+		threadAllocated(thread, sizeNew);
+
+	return pNew + MALLOC_USER_OFFSET;
+}
+
+// Release an untracked block. It is not counted if its header was
+// overwritten.
+static void countedFree(void *pMem)
+{
+	uint64_t header = *HEADER_OF(pMem);
+
+	if (countedHeader(pMem, header))
+		threadFreed(HEADER_THREAD(header), HEADER_SIZE(header));
+	free(HEADER_OF(pMem));
+}
+
+#if MEMTRACK_LEVEL == MEMTRACK_COUNTERS
+
+// Our replacement for malloc().
+void *__Malloc(size_t size, char *file, int line)
+{
+	INIT_TRACKER();
+	return countedMalloc(size, file, line);
+}
+
+// Our replacement for calloc().
+void *__Calloc(size_t num, size_t size, char *file, int line)
+{
+	INIT_TRACKER();
+	return countedCalloc(num, size, file, line);
+}
+
+// Our replacement for realloc().
+void *__Realloc(void *pMem, size_t size, char *file, int line)
+{
+	// If size is zero, free the memory.
+	if (size == 0)
+	{
+		__Free(pMem, file, line);
+		return NULL;
+	}
+
+	// If pointer is NULL, then allocate new memory.
+	if (pMem == NULL)
+		return __Malloc(size, file, line);
+
+	return countedRealloc(pMem, size, file, line);
+}
+
+// Our replacement for free().
+void __Free(void *pMem, char *file, int line)
+{
+	if (pMem)
+		countedFree(pMem);
+	else
+		fprintf(stderr, "*** WARNING: free() received a NULL pointer: %s, line #%d\n", file, line);
+}
+
+#else
+
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+// Allocations of the calling thread until its next sample, and its random
+// state.
+static MEM_THREAD_LOCAL uint32_t sampleCountdown = 0;
+static MEM_THREAD_LOCAL uint32_t sampleRandom = 0;
+
+// Take on average 1 in MEMTRACK_SAMPLE_RATE allocations of each thread for
+// full tracking. The gap to the next sample is drawn from 1 to twice the
+// rate, so a pattern repeating with the rate is not always sampled at the
+// same point. Counted down per thread, so threads share no counter.
+static bool takeSample(void)
+{
+	if (sampleCountdown != 0)
+	{
+		sampleCountdown--;
+		return false;
+	}
+
+	// Xorshift, seeded from the address of the thread's state.
+	if (sampleRandom == 0)
+		sampleRandom = (uint32_t)(uintptr_t)&sampleRandom | 1;
+	sampleRandom ^= sampleRandom << 13;
+	sampleRandom ^= sampleRandom >> 17;
+	sampleRandom ^= sampleRandom << 5;
+	sampleCountdown = sampleRandom % (2 * MEMTRACK_SAMPLE_RATE - 1);
+
+	return true;
+}
+#endif
+
+// Tracked block layout: [header][padding][memory][padding], the header
+// holds the record index.
+#define SET_HEADER(pRaw, index) (*(uint64_t *)(pRaw) = HEADER_RECORD(index))
+
+// Arena blocks are always tracked, whatever their header holds.
+#ifdef MEMTRACK_ARENA
+#define ARENA_CONTAINS(pMem) arenaContains(pMem)
+#else
+#define ARENA_CONTAINS(pMem) false
+#endif
+
+// True if a block without a record may be released as a counted block. At
+// the full level every block has a record until the exit check has run.
+// Called with the lock held.
+static bool countedBlock(const void *pMem)
+{
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	if (!shuttingDown)
+	{
+		fprintf(stderr, "*** WARNING: 0x%p memory not allocated.\n", pMem);
+		return false;
+	}
+#else
+	(void)pMem;
+#endif
+	return true;
+}
+
+// Sample the memory timeline when due. Called with the lock held.
+static void sampleTimeline(uint64_t now)
+{
+	if (timelineDue(now))
+		timelineSample(now, threadLiveBytes());
+}
+
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+// Total memory counts only the tracked blocks, so watermarks are checked
+// against the live bytes of all blocks. The calling thread's share is
+// exact, the others' are summed at most every MEMTRACK_LIVE_REFRESH_MS.
+#define LIVE_ABOVE(bytes) ((bytes) != SIZE_MAX && threadLiveEstimate(clockNanoseconds()) > (bytes))
+#define LIVE_BELOW(bytes) ((bytes) != 0 && threadLiveEstimate(clockNanoseconds()) < (bytes))
+#define LIVE_MEMORY()     threadLiveBytes()
+#else
+#define LIVE_ABOVE(bytes) (totalMemory > (bytes))
+#define LIVE_BELOW(bytes) (totalMemory < (bytes))
+#define LIVE_MEMORY()     totalMemory
+#endif
+
+// Capture the heap for the reporter thread. Called with the lock held.
+// Without a reporter (it could not be started, or has stopped at exit)
+// the capture is written out here, so under the lock: other threads
+// wait on their next tracked allocation or free until it is written.
+static void captureHeap(uint32_t reason)
+{
+	if (watermarkCapture(LIVE_MEMORY(), reason))
+	{
+		if (reporterReady)
+			semaphorePost(&reportRequest);
+		else
+			watermarkStream(reportFd);
+	}
+}
+
+// After memory grew, capture the heap if the site (siteCrossed) or total
+// crossed a watermark. Below them this is a single compare of the total.
+#define WATERMARK_GROWN(siteCrossed, site) \
+	if ((siteCrossed) || LIVE_ABOVE(watermarkTrigger)) \
+		captureHeap((siteCrossed) ? (site) : WATERMARK_TOTAL)
+
+// After memory shrank, re-arm the total watermark once below its hysteresis.
+#define WATERMARK_SHRUNK() \
+	if (LIVE_BELOW(watermarkRearm)) \
+		watermarkArm()
+
+#ifdef MEMTRACK_ARENA
+// Allocate a tracked block from the arenas, NULL if too large or its class is full.
+static void *allocateArenaMemory(size_t size, const unsigned char status, char *file, int line) 
+{
+	uint64_t now;
+	uint32_t thread, site, index;
+	uint8_t *pMem = NULL;
+	bool crossed;
+
+	// Zero sized blocks take the usual path.
+	if (size == 0 || size > ARENA_MAX_SIZE)
+		return NULL;
+
+	now = clockNanoseconds();
+	thread = threadCurrent();
+
+	lockAcquire(&trackerLock);
+
+	// Only counted once the exit check has run.
+	if (shuttingDown)
+	{
+		lockRelease(&trackerLock);
+		return NULL;
+	}
+	site = siteLookup(file, line);
+
+	// The record comes first, the slot keeps its index. The slot arrives painted.
+	index = storeCreate(NULL, size, TAG_MAKE(status, thread, site), STORE_TIME(now));
+	if (index != BLOCK_NONE && (pMem = arenaAllocate(size, index)) != NULL) 
+	{
+		storeSetMemory(index, pMem);
+		if (status == BLOCK_STATUS_CALLOC)
+			memset(pMem, 0, size);
+		SET_HEADER(pMem - MALLOC_USER_OFFSET, index);
+		accountAdd(index);
+
+		// Keep count of total allocations.
+		totalMemory += size;
+		threadAllocated(thread, size);
+		crossed = siteAllocated(site, size, now);
+		WATERMARK_GROWN(crossed, site);
+		sampleTimeline(now);
+	}
+	else if (index != BLOCK_NONE)
+		storeRelease(index);
+
+	lockRelease(&trackerLock);
+
+	return pMem;
+}
+
+// Resize an arena block within its slot, NULL if it no longer fits. Called
+// with the lock held.
+static void *resizeArenaMemory(uint8_t *pMem, size_t sizeNew) 
+{
+	uint32_t index = getBlockInfo(pMem);
+	uint32_t thread, site;
+	size_t sizeOld;
+	bool crossed;
+
+	assert(index != BLOCK_NONE && pMem == blocks.pMem[index]);
+
+	thread = TAG_THREAD(blocks.tag[index]);
+	site = TAG_SITE(blocks.tag[index]);
+	sizeOld = storeSize(index);
+	if (sizeNew > arenaCapacity(pMem))
+		return NULL;
+
+	// When shrinking, the released tail becomes padding. When growing the
+	// padding already reads as uninitialized.
+	if (sizeNew < sizeOld)
+		memset(pMem + sizeNew, _cleanLandFill, sizeOld - sizeNew);
+
+	accountRemove(index);
+	updateBlockInfo(index, pMem, sizeNew, BLOCK_STATUS_REALLOC);
+	accountAdd(index);
+
+	// Recalculate the total memory count.
+	totalMemory = totalMemory - sizeOld + sizeNew;
+	threadResized(thread, sizeOld, sizeNew);
+	crossed = siteResized(site, sizeOld, sizeNew);
+	WATERMARK_GROWN(crossed, site);
+	WATERMARK_SHRUNK();
+	sampleTimeline(clockNanoseconds());
+
+	return pMem;
+}
+
+// Move an arena block which outgrew its slot to a larger slot or a system
+// block. The moved block gets a new record with the allocation time and
+// site of the old one, and the old slot goes to quarantine as free'd. It
+// counts as a resize, not an allocation and a free. Called with the lock
+// held.
+static void *moveArenaMemory(uint8_t *pMem, size_t sizeNew, char *file, int line) 
+{
+	uint32_t index = getBlockInfo(pMem);
+	uint32_t tag = blocks.tag[index];
+	uint32_t thread = TAG_THREAD(tag);
+	uint32_t site = TAG_SITE(tag);
+	size_t sizeOld = storeSize(index);
+	uint32_t indexNew;
+	uint8_t *pNew;
+	bool crossed;
+
+	indexNew = storeCreate(NULL, sizeNew, TAG_MAKE(TAG_STATUS(tag) | BLOCK_STATUS_REALLOC, thread, site), blocks.allocTime[index]);
+	if (indexNew == BLOCK_NONE) 
+	{
+		fprintf(stderr, "*** WARNING: realloc() failure: %s, line #%d\n", file, line);
+		return NULL;
+	}
+
+	// A larger slot arrives painted, a system block is painted here.
+	if ((pNew = arenaAllocate(sizeNew, indexNew)) == NULL) 
+	{
+		uint8_t *pRaw = (uint8_t *)malloc(sizeNew + MALLOC_HEADER + MALLOC_PADDING);
+
+		if (pRaw == NULL) 
 		{
-			// Get size of memory block.
-			size_t size = pbi->size;
-
-			// Has memory been freed?
-			if (!CHECK_BLOCK_FREE(pbi->status))
-				fprintf(stderr, "*** WARNING: Memory not free'd at 0x%p.\n", pbi->pMem);
-			else 
-				// Check for dead memory access.
-				for (uint16_t i = 0; i < size; i++)
-					if (*(pbi->pMem + i) != _deadLandFill)
-						fprintf(stderr, "*** WARNING: Free'd memory access detected at 0x%p.\n", pbi->pMem + i);
-
-			// Free memory and blockinfo for this pointer.
-			free(pbi->pMem - MALLOC_START_OFFSET);
-			freeBlockInfo(pbi->pMem);
-
-			// Process next block.
-			pbi = next;
+			storeRelease(indexNew);
+			fprintf(stderr, "*** WARNING: realloc() failure: %s, line #%d\n", file, line);
+			return NULL;
 		}
+		memset(pRaw + MALLOC_HEADER, _cleanLandFill, sizeNew + MALLOC_PADDING);
+		pNew = pRaw + MALLOC_USER_OFFSET;
 	}
+	storeSetMemory(indexNew, pNew);
+	SET_HEADER(pNew - MALLOC_USER_OFFSET, indexNew);
+	accountAdd(indexNew);
+	memcpy(pNew, pMem, sizeOld);
+
+	// The old slot is checked as it leaves quarantine.
+	setMemoryStatus(index);
+	accountFreed(index);
+	memset(pMem, _deadLandFill, sizeOld);
+	arenaFree(pMem);
+
+	// Recalculate the total memory count.
+	totalMemory = totalMemory - sizeOld + sizeNew;
+	threadResized(thread, sizeOld, sizeNew);
+	crossed = siteResized(site, sizeOld, sizeNew);
+	WATERMARK_GROWN(crossed, site);
+	sampleTimeline(clockNanoseconds());
+
+	return pNew;
 }
+#endif
 
+// Once the exit check has run, copy a tracked block of sizeOld bytes (0 if
+// free'd) to a counted block. The old block is left to the system.
+static void *shutdownRealloc(uint8_t *pMem, size_t sizeOld, size_t sizeNew, char *file, int line)
+{
+	uint8_t *pNew;
+
+	if (sizeOld == 0)
+	{
+		fprintf(stderr, "*** WARNING: 0x%p memory previously free'd.\n", pMem);
+		return NULL;
+	}
+
+	if ((pNew = (uint8_t *)countedMalloc(sizeNew, file, line)) != NULL)
+		memcpy(pNew, pMem, sizeOld < sizeNew ? sizeOld : sizeNew);
+
+	return pNew;
+}
+
+// Resize a tracked block. Called with the lock held.
 static void *resizeMemory(void **ppv, size_t sizeNew, char *file, int line) 
 {
 	uint8_t **ppb = (uint8_t **)ppv;
 	uint8_t *pNew;
-	size_t sizeOld = sizeOfBlock(*ppb);
+	uint32_t index = getBlockInfo(*ppb);
+	size_t sizeOld = storeSize(index);
+	uint32_t thread = TAG_THREAD(blocks.tag[index]);
+	uint32_t site = TAG_SITE(blocks.tag[index]);
+	bool crossed;
 
 	if (sizeNew < sizeOld)
 		memset((*ppb) + sizeNew, _deadLandFill, sizeOld - sizeNew);
@@ -233,65 +1150,113 @@ static void *resizeMemory(void **ppv, size_t sizeNew, char *file, int line)
 		}
 	}
 */
-	pNew = (uint8_t *)realloc(*ppb - MALLOC_START_OFFSET, sizeNew + MALLOC_PADDING);
+	// The old block is measured while it still exists.
+	accountRemove(index);
+	pNew = (uint8_t *)realloc(*ppb - MALLOC_USER_OFFSET, sizeNew + MALLOC_HEADER + MALLOC_PADDING);
 	
-	if (pNew != NULL) 
+	// Failure, original block is untouched.
+	if (pNew == NULL) 
 	{
-		if (pNew != *ppb) 
-		{
-			createBlockInfo((uint8_t *)pNew + MALLOC_START_OFFSET, sizeNew, getBlockStatus(*ppb) + BLOCK_STATUS_REALLOC);
-			freeBlockInfo(*ppb);
-		}
-		else
-			updateBlockInfo(*ppv, pNew + MALLOC_START_OFFSET, sizeNew, BLOCK_STATUS_REALLOC);
-
-		if (sizeNew > sizeOld)
-			memset(pNew + sizeOld, _cleanLandFill, sizeNew - sizeOld);
+		accountAdd(index);
+		fprintf(stderr, "*** WARNING: realloc() failure: %s, line #%d\n", file, line);
+		return NULL;
 	}
+	SET_HEADER(pNew, index);
+
+	// Update the existing record even if the block moved.
+	updateBlockInfo(index, pNew + MALLOC_USER_OFFSET, sizeNew, BLOCK_STATUS_REALLOC);
+	accountAdd(index);
+
+	if (sizeNew > sizeOld)
+		memset(pNew + MALLOC_USER_OFFSET + sizeOld, _cleanLandFill, sizeNew - sizeOld);
 
 	// Paint the memory padding.
-	memset(pNew, _cleanLandFill, MALLOC_PADDING_LENGTH);
-	memset((uint8_t *)pNew + MALLOC_PADDING_LENGTH + sizeNew, _cleanLandFill, MALLOC_PADDING_LENGTH);
+	memset(pNew + MALLOC_HEADER, _cleanLandFill, MALLOC_PADDING_LENGTH);
+	memset(pNew + MALLOC_USER_OFFSET + sizeNew, _cleanLandFill, MALLOC_PADDING_LENGTH);
 
 	// Recalculate the total memory count.
 	totalMemory = totalMemory - sizeOld + sizeNew;
+	threadResized(thread, sizeOld, sizeNew);
+	crossed = siteResized(site, sizeOld, sizeNew);
+	WATERMARK_GROWN(crossed, site);
+	WATERMARK_SHRUNK();
+	sampleTimeline(clockNanoseconds());
 
 #ifdef VERBOSE
 	// Print statistics.
 	fprintf(stderr, "realloc: %s, line #%d\n", file, line);
-	fprintf(stderr, " 0x%p, size: %d, total: %d\n", (uint8_t *)pNew + MALLOC_START_OFFSET, sizeNew, totalMemory);
+	fprintf(stderr, " 0x%p, size: %d, total: %d\n", pNew + MALLOC_USER_OFFSET, sizeNew, totalMemory);
 #endif
 
 	// Return new pointer.
-	return pNew + MALLOC_START_OFFSET;
+	return pNew + MALLOC_USER_OFFSET;
 }
 
 // Our replacement for malloc().
 void *__Malloc(size_t size, char *file, int line) 
 {
+	INIT_TRACKER();
+
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	if (!takeSample())
+		return countedMalloc(size, file, line);
+#endif
+
+#ifdef MEMTRACK_ARENA
+	// Small blocks are served from the arenas.
+	void *pArena = allocateArenaMemory(size, BLOCK_STATUS_MALLOC, file, line);
+	if (pArena != NULL)
+		return pArena;
+#endif
+
 	// Attempt to allocate requested size + our below/above padding.
-	void *pMem = malloc(size + MALLOC_PADDING);
+	uint8_t *pMem = (uint8_t *)malloc(size + MALLOC_HEADER + MALLOC_PADDING);
+	uint64_t now = clockNanoseconds();
+	uint32_t thread = threadCurrent();
+	uint32_t site, index;
+	bool crossed;
+
+	lockAcquire(&trackerLock);
 
-	// Attempt to create an info block for this memory.
-	if (pMem != NULL && createBlockInfo((uint8_t *)pMem + MALLOC_START_OFFSET, size, BLOCK_STATUS_MALLOC)) 
+	// Only counted once the exit check has run.
+	if (shuttingDown)
+	{
+		lockRelease(&trackerLock);
+		free(pMem);
+		return countedMalloc(size, file, line);
+	}
+	site = siteLookup(file, line);
+
+	// Attempt to create a record for this memory.
+	if (pMem != NULL && (index = createBlockInfo(pMem + MALLOC_USER_OFFSET, size, BLOCK_STATUS_MALLOC, thread, site, now)) != BLOCK_NONE)
 	{
 		// Paint the memory as uninitailized.
-		memset(pMem, _cleanLandFill, size + MALLOC_PADDING);
+		memset(pMem + MALLOC_HEADER, _cleanLandFill, size + MALLOC_PADDING);
+		SET_HEADER(pMem, index);
 
 		// Keep count of total allocations.
 		totalMemory += size;
+		threadAllocated(thread, size);
+		crossed = siteAllocated(site, size, now);
+		WATERMARK_GROWN(crossed, site);
+		sampleTimeline(now);
 
 #ifdef VERBOSE
 		// Print statistics.
 		fprintf(stderr, "malloc: %s, line #%d\n", file, line);
-		fprintf(stderr, " 0x%p, size: %d, total: %d\n", (uint8_t *)pMem + MALLOC_START_OFFSET, size, totalMemory);
+		fprintf(stderr, " 0x%p, size: %d, total: %d\n", pMem + MALLOC_USER_OFFSET, size, totalMemory);
 #endif
 
+		lockRelease(&trackerLock);
+
 		// Return memory requested.
-		return((uint8_t *)pMem + MALLOC_START_OFFSET);
+		return(pMem + MALLOC_USER_OFFSET);
 	}
 
+	lockRelease(&trackerLock);
+
 	// Failure.
+	free(pMem);
 	fprintf(stderr, "*** WARNING: malloc() failure: %s, line #%d\n", file, line);
 	
 	return NULL;
@@ -300,30 +1265,75 @@ void *__Malloc(size_t size, char *file, int line)
 // Our replacement for calloc().
 void *__Calloc(size_t num, size_t size, char *file, int line) 
 {
+	INIT_TRACKER();
+
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	if (!takeSample())
+		return countedCalloc(num, size, file, line);
+#endif
+
+	if (CALLOC_OVERFLOW(num, size))
+	{
+		fprintf(stderr, "*** WARNING: calloc() failure: %s, line #%d\n", file, line);
+		return NULL;
+	}
+
+#ifdef MEMTRACK_ARENA
+	// Small blocks are served from the arenas.
+	void *pArena = allocateArenaMemory(num*size, BLOCK_STATUS_CALLOC, file, line);
+	if (pArena != NULL)
+		return pArena;
+#endif
+
 	// Attempt to allocate requested size + our below/above padding.
-	void *pMem = calloc(num + MALLOC_PADDING, size);
+	uint8_t *pMem = (uint8_t *)calloc(num*size + MALLOC_HEADER + MALLOC_PADDING, 1);
+	uint64_t now = clockNanoseconds();
+	uint32_t thread = threadCurrent();
+	uint32_t site, index;
+	bool crossed;
 
-	// Attempt to create an info block for this memory.
-	if (pMem != NULL && createBlockInfo((uint8_t *)pMem + MALLOC_START_OFFSET, num*size, BLOCK_STATUS_CALLOC)) 
+	lockAcquire(&trackerLock);
+
+	// Only counted once the exit check has run.
+	if (shuttingDown)
+	{
+		lockRelease(&trackerLock);
+		free(pMem);
+		return countedCalloc(num, size, file, line);
+	}
+	site = siteLookup(file, line);
+
+	// Attempt to create a record for this memory.
+	if (pMem != NULL && (index = createBlockInfo(pMem + MALLOC_USER_OFFSET, num*size, BLOCK_STATUS_CALLOC, thread, site, now)) != BLOCK_NONE)
 	{
 		// Paint the memory padding.
-		memset(pMem, _cleanLandFill, MALLOC_PADDING_LENGTH);
-		memset((uint8_t *)pMem + MALLOC_PADDING_LENGTH + num*size, _cleanLandFill, MALLOC_PADDING_LENGTH);
+		memset(pMem + MALLOC_HEADER, _cleanLandFill, MALLOC_PADDING_LENGTH);
+		memset(pMem + MALLOC_USER_OFFSET + num*size, _cleanLandFill, MALLOC_PADDING_LENGTH);
+		SET_HEADER(pMem, index);
 
 		// Keep count of total allocations.
 		totalMemory += num*size;
+		threadAllocated(thread, num*size);
+		crossed = siteAllocated(site, num*size, now);
+		WATERMARK_GROWN(crossed, site);
+		sampleTimeline(now);
 
 #ifdef VERBOSE
 		// Print statistics.
 		fprintf(stderr, "calloc: %s, line #%d\n", file, line);
-		fprintf(stderr, " 0x%p, size: %d, total: %d\n", (uint8_t *)pMem + MALLOC_START_OFFSET, num*size, totalMemory);
+		fprintf(stderr, " 0x%p, size: %d, total: %d\n", pMem + MALLOC_USER_OFFSET, num*size, totalMemory);
 #endif
 
+		lockRelease(&trackerLock);
+
 		// Return memory requested.
-		return((uint8_t *)pMem + MALLOC_START_OFFSET);
+		return(pMem + MALLOC_USER_OFFSET);
 	}
 
+	lockRelease(&trackerLock);
+
 	// Failure.
+	free(pMem);
 	fprintf(stderr, "*** WARNING: calloc() failure: %s, line #%d\n", file, line);
 	
 	return NULL;
@@ -355,12 +1365,68 @@ void *__Realloc(void *pMem, size_t size, char *file, int line)
 #endif
 
 		pMem = __Malloc(size, file, line);
-		updateBlockInfo(pMem, pMem, size, BLOCK_STATUS_REALLOC);
+
+		if (pMem != NULL && (*HEADER_OF(pMem) & HEADER_TRACKED))
+		{
+			lockAcquire(&trackerLock);
+			updateBlockInfo(getBlockInfo(pMem), pMem, size, BLOCK_STATUS_REALLOC);
+			lockRelease(&trackerLock);
+		}
+
 		return pMem;
 	}
 
-	return resizeMemory(&pMem, size, file, line);
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	// Unsampled blocks are only counted, without taking the lock.
+	if (!(*HEADER_OF(pMem) & HEADER_TRACKED) && !ARENA_CONTAINS(pMem))
+		return countedRealloc(pMem, size, file, line);
+#endif
+
+	lockAcquire(&trackerLock);
+
+	// Determine the record of this memory block, if it has one.
+	uint32_t index = findBlock(pMem);
+
+	// Once the exit check has run, copy a tracked block to a counted block.
+	// The record is kept unless the block was free'd.
+	if (shuttingDown && (index != BLOCK_NONE || (*HEADER_OF(pMem) & HEADER_TRACKED)))
+	{
+		size_t sizeOld = 0;
+
+		if (index != BLOCK_NONE && !CHECK_BLOCK_FREE(blocks.tag[index]))
+			sizeOld = storeSize(index);
+		lockRelease(&trackerLock);
+
+		return shutdownRealloc(pMem, sizeOld, size, file, line);
+	}
+
+#ifdef MEMTRACK_ARENA
+	if (arenaContains(pMem)) 
+	{
+		void *pNew = resizeArenaMemory(pMem, size);
+
+		// Outgrew its slot, move to a new block.
+		if (pNew == NULL)
+			pNew = moveArenaMemory(pMem, size, file, line);
+		lockRelease(&trackerLock);
+
+		return pNew;
+	}
+#endif
+
+	// Untracked blocks are only counted.
+	if (index == BLOCK_NONE)
+	{
+		bool counted = countedBlock(pMem);
 
+		lockRelease(&trackerLock);
+		return counted ? countedRealloc(pMem, size, file, line) : NULL;
+	}
+
+	pMem = resizeMemory(&pMem, size, file, line);
+	lockRelease(&trackerLock);
+
+	return pMem;
 }
 
 // Our replacement for free().
@@ -368,7 +1434,50 @@ void __Free(void *pMem, char *file, int line)
 {
 	if (pMem) 
 	{
-		// Determine size of this memory block.
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+		// Unsampled blocks are only counted, without taking the lock.
+		if (!(*HEADER_OF(pMem) & HEADER_TRACKED) && !ARENA_CONTAINS(pMem))
+		{
+			countedFree(pMem);
+			return;
+		}
+#endif
+
+		uint64_t now = clockNanoseconds();
+
+		lockAcquire(&trackerLock);
+
+		// Determine the record of this memory block, if it has one.
+		uint32_t index = findBlock(pMem);
+
+		// Once the exit check has run, tracked blocks are left to the system.
+		if (shuttingDown && (index != BLOCK_NONE || (*HEADER_OF(pMem) & HEADER_TRACKED)))
+		{
+			lockRelease(&trackerLock);
+			return;
+		}
+
+#ifdef MEMTRACK_ARENA
+		// An arena slot no longer in use (free'd and reused).
+		if (index == BLOCK_NONE && arenaContains(pMem)) 
+		{
+			fprintf(stderr, "*** WARNING: 0x%p memory previously free'd.\n", pMem);
+			lockRelease(&trackerLock);
+			return;
+		}
+#endif
+
+		// Untracked blocks are only counted.
+		if (index == BLOCK_NONE)
+		{
+			bool counted = countedBlock(pMem);
+
+			lockRelease(&trackerLock);
+			if (counted)
+				countedFree(pMem);
+			return;
+		}
+
 		size_t size = sizeOfBlock(pMem);
 		assert(totalMemory >= size);
 
@@ -379,14 +1488,20 @@ void __Free(void *pMem, char *file, int line)
 #endif
 
 		// Check/designate this memory as free.
-		if (!setMemoryStatus(pMem)) 
+		if (!setMemoryStatus(index)) 
 		{
 			fprintf(stderr, "*** WARNING: 0x%p memory previously free'd.\n", pMem);
+			lockRelease(&trackerLock);
 			return;
 		}
+		accountFreed(index);
 
 		// Decrement total memory count.
 		totalMemory -= size;
+		threadFreed(TAG_THREAD(blocks.tag[index]), size);
+		siteFreed(TAG_SITE(blocks.tag[index]), size, STORE_LIFETIME(index, now));
+		WATERMARK_SHRUNK();
+		sampleTimeline(now);
 
 		// Check for memory access under-run.
 		uint8_t *pPad = (uint8_t *)pMem - MALLOC_START_OFFSET;
@@ -402,25 +1517,24 @@ void __Free(void *pMem, char *file, int line)
 
 		// Paint memory as dead.
 		memset(pMem, _deadLandFill, size);
+
+#ifdef MEMTRACK_ARENA
+		// Arena slots wait in quarantine before reuse.
+		if (arenaContains(pMem))
+			arenaFree(pMem);
+#endif
+
+		lockRelease(&trackerLock);
 	}
 	else
 		fprintf(stderr, "*** WARNING: free() received a NULL pointer: %s, line #%d\n", file, line);
 }
 
-// Our replacement for exit().
+#endif
+
+// Our replacement for exit(). Allocations are checked by the atexit() handler.
 void __Exit(int const status) 
 {
-	// Check all released memory.	
-	checkAllocations();
-
-	// Report if all memory released.
-	if (!totalMemory)
-		fputs("\nAll memory de-allocated.", stderr);
-
-	// Pause upon exit.
-	fputs("\nPress Control - C to exit.\n", stderr);
-	while (getchar() != EOF);
-
 	// Perform actual system exit.
 	exit(status);
 }
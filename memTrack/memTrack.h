@@ -10,15 +10,36 @@
 * Notes:
 *  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
 *      language options.
-*  (2) Not compiled in release version.
+*  (2) Only the parts needed by MEMTRACK_LEVEL are declared (see memLevel.h).
 *  (3) Include the files memTrack.h, memTrack.c and memTracker.h in your 
 *      project. Only include "memTracker.h" in your files. Do not explicitly 
 *      include this header in your project files.
 *  (4) Define VERBOSE to recieve malloc/free debug prints.
-*  (5) Released into the public domain.
+*  (5) Allocations are checked at exit (via atexit) and listed on abort.
+*      A report can be requested at any time with requestReport() or, on
+*      POSIX systems, by sending SIGUSR1 (see MEMTRACK_REPORT_SIGNAL)
+*      unless the program has its own handler for it. waitForReport()
+*      waits for the requested reports to be written.
+*  (6) Allocation lifetimes are profiled per site, and total memory is
+*      sampled over time, see reportProfile() and memProfile.h.
+*  (7) Spans of memory can be validated in bulk against the tracked
+*      blocks, see validateSpans().
+*  (8) A heap capture (live memory per site) is written when live
+*      memory rises above a watermark, see setWatermark() and memWatch.h.
+*  (9) Released into the public domain.
 *************************************************************************
 * Change Log:
 *   11/13/2017: Initial release. JME
+*   10/19/2026: Added streamed and on-demand reporting. JME
+*   10/19/2026: Internal state and prototypes moved to memTrack.c. JME
+*   10/19/2026: Added lifetime and timeline profiling. JME
+*   10/19/2026: Added tracking levels and allocation counters. JME
+*   10/19/2026: Added per-thread accounting. JME
+*   10/19/2026: Block records moved to the record store (memStore.h). JME
+*   10/19/2026: Added batched span validation. JME
+*   10/19/2026: Added watermark heap captures. JME
+*   10/19/2026: Added overhead and fragmentation accounting. JME
+*   10/19/2026: Added waitForReport(). JME
 *************************************************************************/
 #include <stdio.h>
 #include <stdlib.h>
@@ -28,24 +49,55 @@
 #include <stdbool.h>
 #include <stdint.h>
 #include <assert.h>
+#include "memLevel.h"
 
 #ifndef _DEBUG_MALLOC_H_
 #define _DEBUG_MALLOC_H_
 
-#ifdef _DEBUG
+// Allocation counters, kept at every tracking level.
+typedef struct MEMCOUNTERS {
+	uint64_t allocations; // Number of allocations.
+	uint64_t frees;       // Number of frees.
+	uint64_t liveBytes;   // Bytes currently allocated.
+	uint64_t peakBytes;   // Sum of per-thread peaks, at least the highest liveBytes.
+} memcounters;
+
+// Breakdown of the memory behind the tracked blocks, see getMemoryOverhead().
+typedef struct MEMOVERHEAD {
+	uint64_t userBytes;       // Bytes requested by live blocks.
+	uint64_t canaryBytes;     // Padding around live blocks.
+	uint64_t metadataBytes;   // Block headers, records and side tables.
+	uint64_t quarantineBytes; // Free'd blocks not yet released.
+	uint64_t slackBytes;      // Allocator rounding and unused arena slots.
+} memoverhead;
+
+// Span of memory to validate, see validateSpans().
+typedef struct MEMSPAN {
+	const void *pMem; // Start of span.
+	size_t size;      // Length of span.
+} memspan;
+
+// Span validation results.
+#define SPAN_VALID   0 // Within a live block.
+#define SPAN_INVALID 1 // NULL pointer or zero length.
+#define SPAN_UNKNOWN 2 // Not within any tracked block.
+#define SPAN_FREED   3 // Within a free'd block.
+#define SPAN_OVERRUN 4 // Starts within a live block but runs past its end.
+
+// Span which failed validation.
+typedef struct MEMSPANERROR {
+	size_t span;          // Index of the span.
+	unsigned char status; // Why it failed (SPAN_*).
+} memspanerror;
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
 
 // Define VERBOSE_OUTPUT (below) to recieve malloc/free debug prints.
 //#define VERBOSE
 
-// Memory allocation stats.
-typedef struct BLOCKINFO {
-	struct BLOCKINFO *pbiNext; // Pointer to next element in structure.
-	uint8_t *pMem;             // Memory pointer.
-	size_t size;               // Size of requested block.
-	unsigned char status;      // Block status bits (how allocated, realloc'd and free).
-} blockinfo;
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
 
-// Memory allocation status definitions.
+// Memory allocation status definitions (4 bits, see memStore.h).
 #define BLOCK_STATUS_UNKNOWN 0x00
 #define BLOCK_STATUS_MALLOC  0x01
 #define BLOCK_STATUS_CALLOC  0x02
@@ -57,17 +109,31 @@ typedef struct BLOCKINFO {
 #define CHECK_BLOCK_REALLOC(var) ((var>>2) & 1)
 #define CHECK_BLOCK_FREE(var)    ((var>>3) & 1)
 
+// Memory paint values.
+static const unsigned char _cleanLandFill = 0xCC; // Fill new memory with this value.
+static const unsigned char _deadLandFill = 0xDD;  // Fill free memory with this value.
+
+#endif
+
 // Memory allocation is expanded by padding amount (equally spaced before/after actual).
 #define MALLOC_PADDING        16 // Should be an even value.
 #define MALLOC_PADDING_LENGTH (MALLOC_PADDING / 2)
 #define MALLOC_START_OFFSET   (MALLOC_PADDING / 2)
 
-// Memory paint values.
-static unsigned char _cleanLandFill = 0xCC; // Fill new memory with this value.
-static unsigned char _deadLandFill = 0xDD;  // Fill free memory with this value.
+// Every block is preceded by a header word. A tracked block holds its
+// record index and HEADER_TRACKED, a counted block its size and allocating
+// thread.
+#define MALLOC_HEADER  8
+#define HEADER_TRACKED 1
+#define HEADER_RECORD(index) (((uint64_t)(index) << 1) | HEADER_TRACKED)
+#define HEADER_INDEX(header) ((uint32_t)((header) >> 1))
+#define HEADER_MAKE(size, thread, tracked) (((uint64_t)(size) << 17) | ((uint64_t)(thread) << 1) | (tracked))
+#define HEADER_SIZE(header)   ((size_t)((header) >> 17))
+#define HEADER_THREAD(header) ((uint32_t)((header) >> 1) & 0xFFFF)
 
-// Records total memory allocations.
-static size_t totalMemory = 0;
+// Offset from start of system allocation to user memory.
+#define MALLOC_USER_OFFSET (MALLOC_HEADER + MALLOC_START_OFFSET)
+#define HEADER_OF(pMem)    ((uint64_t *)((uint8_t *)(pMem) - MALLOC_USER_OFFSET))
 
 // Redirection function definitions.
 void *__Malloc(size_t, char *, int);
@@ -77,18 +143,24 @@ void __Free(void *, char *, int);
 void __Exit(int const);
 
 // Additional function definitions (can be called outside of memTracker).
-size_t sizeOfBlock(const uint8_t *);
 void reportAllocations(void);
+void reportAllocationsTo(int);
+void setReportDescriptor(int);
+void requestReport(void);
+bool waitForReport(unsigned int);
+void getAllocationCounters(memcounters *);
 
-// Internal function definitions.
-static bool setMemoryStatus(const void *);
-static unsigned char getBlockStatus(const void *);
-static bool createBlockInfo(uint8_t *, const size_t, const unsigned char);
-static void updateBlockInfo(const uint8_t *, uint8_t *, const size_t, const unsigned char);
-static blockinfo *getBlockInfo(const uint8_t *);
-static void freeBlockInfo(const uint8_t *);
-static void checkAllocations(void);
-static void *resizeMemory(void **, size_t, char *, int);
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+size_t sizeOfBlock(const uint8_t *);
+void reportProfile(void);
+void reportProfileTo(int);
+void setTimelineInterval(unsigned int);
+size_t validateSpans(const memspan *, size_t, uint8_t *, memspanerror *, size_t);
+void setWatermark(size_t);
+void setSiteWatermark(size_t);
+void getMemoryOverhead(memoverhead *);
+
+#endif
 
 #endif
 
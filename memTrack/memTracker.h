@@ -10,19 +10,32 @@
 * Notes:
 *  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
 *      language options.
-*  (2) Does not compile in release version.
+*  (2) The tracking level is selected at compile time by MEMTRACK_LEVEL:
+*      MEMTRACK_OFF (plain system calls, the release default),
+*      MEMTRACK_COUNTERS (counts and live/peak bytes, suitable for
+*      optimized builds), MEMTRACK_SAMPLED (counters plus full tracking of
+*      1 in MEMTRACK_SAMPLE_RATE allocations) or MEMTRACK_FULL (the debug
+*      default). Define it project wide, memTrack.c must see the same level.
 *  (3) Include this header file in your program to use memTracker.
 *  (4) Define VERBOSE_OUTPUT to recieve malloc/free debug prints.
-*  (5) Released into the public domain.
+*  (5) Allocations are checked when the program exits, whether through
+*      exit() or a return from main(). Nothing waits for input.
+*  (6) Released into the public domain.
 *************************************************************************
 * Change Log:
 *   11/13/2017: Initial release. JME
+*   10/19/2026: Exit no longer pauses, check runs from atexit(). JME
+*   10/19/2026: Select tracking level with MEMTRACK_LEVEL. JME
+*   10/19/2026: Added validateSpans(). JME
+*   10/19/2026: Added setWatermark(), setSiteWatermark(). JME
+*   10/19/2026: Added getMemoryOverhead(). JME
+*   10/19/2026: Added waitForReport(). JME
 *************************************************************************/
-#ifdef _DEBUG
-
 // Debug memory allocation routines.
 #include "memTrack.h"
 
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
 // Macros defined after our replacement functions.
 #define malloc(s)     __Malloc(s, __FILE__, __LINE__)
 #define calloc(n, s)  __Calloc(n, s, __FILE__, __LINE__)
@@ -30,5 +43,32 @@
 #define free(p)       __Free(p, __FILE__, __LINE__)
 #define exit(s)       __Exit(s)
 
+#else
+
+// Reports compile away when tracking is off.
+#define reportAllocations()        ((void)0)
+#define reportAllocationsTo(fd)    ((void)(fd))
+#define setReportDescriptor(fd)    ((void)(fd))
+#define requestReport()            ((void)0)
+#define waitForReport(ms)          ((void)(ms), true)
+#define getAllocationCounters(p)   ((void)memset((p), 0, sizeof(memcounters)))
+
+#endif
+
+#if MEMTRACK_LEVEL < MEMTRACK_SAMPLED
+
+// Profiling needs at least sampled tracking.
+#define reportProfile()            ((void)0)
+#define reportProfileTo(fd)        ((void)(fd))
+#define setTimelineInterval(ms)    ((void)(ms))
+#define setWatermark(bytes)        ((void)(bytes))
+#define setSiteWatermark(bytes)    ((void)(bytes))
+#define getMemoryOverhead(p)       ((void)memset((p), 0, sizeof(memoverhead)))
+
+// Span validation needs at least sampled tracking. Nothing is flagged and
+// the outputs are not written.
+#define validateSpans(p, n, pInvalid, pErrors, max) \
+	((void)(p), (void)(n), (void)(pInvalid), (void)(pErrors), (void)(max), (size_t)0)
+
 #endif
 
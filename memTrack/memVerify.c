@@ -0,0 +1,288 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memVerify.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the exit verification. The block records are cut
+* into contiguous shares, one per worker, with the exiting thread taking
+* the first. A worker checks every block of its share is free'd and still
+* painted dead, releases it, and sorts its findings. The exiting thread
+* waits for all workers and merges their sorted findings into the report.
+* Arena blocks, the arena and the records are released afterwards in bulk.
+* Blocks not free'd are reported but left allocated, as later atexit()
+* handlers and running threads may still use them. If any remain, the
+* arena and records are kept and left to the operating system.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Blocks not free'd are no longer released. JME
+*   10/19/2026: Processor limit lifted by MEMTRACK_EXIT_FORCE. JME
+*************************************************************************/
+#include "memVerify.h"
+#include "memPlatform.h"
+#include "memProfile.h"
+#include "memStore.h"
+#include "memArena.h"
+
+// Only compiled at the sampled and full tracking levels.
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Kinds of finding.
+#define FINDING_NOT_FREED   0
+#define FINDING_DEAD_ACCESS 1
+
+// Problem found with one block.
+typedef struct FINDING {
+	uintptr_t address; // Block, or first byte written after free.
+	size_t bytes;      // Block size, or number of bytes written after free.
+	uint32_t site;     // Allocation site.
+	uint32_t kind;     // FINDING_NOT_FREED or FINDING_DEAD_ACCESS.
+} finding;
+
+// Share of the records given to one worker.
+typedef struct VERIFYWORK {
+	uint32_t first;       // First record.
+	uint32_t last;        // One past the last record.
+	finding *pFindings;   // Findings, sorted once the share is done.
+	size_t count;
+	size_t capacity;
+	size_t dropped;       // Findings lost for lack of memory.
+	size_t live;          // Blocks not free'd, left allocated.
+	memsemaphore *pDone;  // Posted by a worker thread when done.
+} verifywork;
+
+// Record a finding.
+static void addFinding(verifywork *pw, uintptr_t address, size_t bytes, uint32_t site, uint32_t kind)
+{
+	if (pw->count == pw->capacity)
+	{
+		size_t capacity = pw->capacity ? pw->capacity * 2 : 64;
+		finding *p = (finding *)realloc(pw->pFindings, capacity * sizeof(finding));
+
+		if (p == NULL)
+		{
+			pw->dropped++;
+			return;
+		}
+		pw->pFindings = p;
+		pw->capacity = capacity;
+	}
+
+	pw->pFindings[pw->count].address = address;
+	pw->pFindings[pw->count].bytes = bytes;
+	pw->pFindings[pw->count].site = site;
+	pw->pFindings[pw->count].kind = kind;
+	pw->count++;
+}
+
+// Count bytes of a free'd block no longer painted dead, returning the first.
+static size_t deadModified(const uint8_t *pMem, size_t size, const uint8_t **ppFirst)
+{
+	const uint64_t dead = 0x0101010101010101ull * _deadLandFill;
+	size_t count = 0;
+	size_t i = 0;
+
+	*ppFirst = NULL;
+	while (i < size)
+	{
+		size_t end = (i + 8 < size) ? i + 8 : size;
+		uint64_t word;
+
+		// Skip a word at a time while still dead.
+		if (end - i == 8)
+		{
+			memcpy(&word, pMem + i, 8);
+			if (word == dead)
+			{
+				i = end;
+				continue;
+			}
+		}
+
+		for (; i < end; i++)
+			if (pMem[i] != _deadLandFill)
+			{
+				if (*ppFirst == NULL)
+					*ppFirst = pMem + i;
+				count++;
+			}
+	}
+
+	return count;
+}
+
+// Order findings by site, then address.
+static bool findingBefore(const finding *pa, const finding *pb)
+{
+	if (pa->site != pb->site)
+		return pa->site < pb->site;
+	return pa->address < pb->address;
+}
+
+static int compareFindings(const void *a, const void *b)
+{
+	const finding *pa = (const finding *)a;
+	const finding *pb = (const finding *)b;
+
+	return findingBefore(pa, pb) ? -1 : findingBefore(pb, pa) ? 1 : 0;
+}
+
+// Check and release the blocks of one share, then sort its findings.
+static void verifyShare(verifywork *pw)
+{
+	for (uint32_t i = pw->first; i < pw->last; i++)
+	{
+		uint32_t tag = blocks.tag[i];
+		uint8_t *pMem = blocks.pMem[i];
+		size_t size;
+
+		// Skip released records.
+		if (tag == 0)
+			continue;
+
+		size = storeSize(i);
+
+		// Has memory been freed? If not it may still be in use.
+		if (!CHECK_BLOCK_FREE(tag))
+		{
+			addFinding(pw, (uintptr_t)pMem, size, TAG_SITE(tag), FINDING_NOT_FREED);
+			pw->live++;
+			continue;
+		}
+
+		// Check for dead memory access.
+		const uint8_t *pFirst;
+		size_t modified = deadModified(pMem, size, &pFirst);
+
+		if (modified)
+			addFinding(pw, (uintptr_t)pFirst, modified, TAG_SITE(tag), FINDING_DEAD_ACCESS);
+
+#ifdef MEMTRACK_ARENA
+		// Arena blocks go with the arena.
+		if (arenaContains(pMem))
+			continue;
+#endif
+
+		// Free memory for this block.
+		free(pMem - MALLOC_USER_OFFSET);
+	}
+
+	if (pw->count > 1)
+		qsort(pw->pFindings, pw->count, sizeof(finding), compareFindings);
+}
+
+// Worker thread entry.
+static void verifyWorker(void *arg)
+{
+	verifywork *pw = (verifywork *)arg;
+
+	verifyShare(pw);
+	semaphorePost(pw->pDone);
+}
+
+// Append one finding.
+static void streamFinding(memstream *ms, const finding *pf)
+{
+	if (pf->kind == FINDING_NOT_FREED)
+		streamPuts(ms, "*** WARNING: Memory not free'd at ");
+	else
+		streamPuts(ms, "*** WARNING: Free'd memory access detected at ");
+	streamHex(ms, pf->address);
+	streamPuts(ms, " (");
+	streamUnsigned(ms, pf->bytes);
+	streamPuts(ms, " bytes, ");
+	streamSite(ms, pf->site);
+	streamPuts(ms, ").\n");
+}
+
+// Check _all_ blocks for leaks and access after free, release the free'd
+// ones, and stream the findings. Called with the lock held.
+void verifyBlocks(memstream *ms)
+{
+	verifywork work[MEMTRACK_EXIT_THREADS + 1];
+	size_t next[MEMTRACK_EXIT_THREADS + 1];
+	memsemaphore done;
+	uint32_t workers = blocks.count / MEMTRACK_EXIT_MIN_RECORDS;
+	uint32_t started = 0;
+	size_t dropped = 0;
+	size_t live = 0;
+
+	// One share per worker, at most one worker per processor unless forced.
+	if (workers > MEMTRACK_EXIT_THREADS)
+		workers = MEMTRACK_EXIT_THREADS;
+#ifndef MEMTRACK_EXIT_FORCE
+	if (workers > processorCount())
+		workers = processorCount();
+#endif
+	if (workers == 0 || (workers > 1 && !semaphoreCreate(&done)))
+		workers = 1;
+
+	memset(work, 0, sizeof(work));
+	for (uint32_t w = 0; w < workers; w++)
+	{
+		work[w].first = (uint32_t)((uint64_t)blocks.count * w / workers);
+		work[w].last = (uint32_t)((uint64_t)blocks.count * (w + 1) / workers);
+		work[w].pDone = &done;
+	}
+
+	// The exiting thread takes the first share, and any share whose
+	// worker fails to start.
+	for (uint32_t w = 1; w < workers; w++)
+		if (threadStart(verifyWorker, &work[w]))
+			started++;
+		else
+			verifyShare(&work[w]);
+	verifyShare(&work[0]);
+
+	for (uint32_t w = 0; w < started; w++)
+		semaphoreWait(&done);
+	if (workers > 1)
+		semaphoreDestroy(&done);
+
+	// Merge the sorted shares.
+	memset(next, 0, sizeof(next));
+	for (;;)
+	{
+		verifywork *pBest = NULL;
+
+		for (uint32_t w = 0; w < workers; w++)
+			if (next[w] < work[w].count && (pBest == NULL || findingBefore(&work[w].pFindings[next[w]], &pBest->pFindings[next[pBest - work]])))
+				pBest = &work[w];
+
+		if (pBest == NULL)
+			break;
+
+		streamFinding(ms, &pBest->pFindings[next[pBest - work]++]);
+	}
+
+	for (uint32_t w = 0; w < workers; w++)
+	{
+		dropped += work[w].dropped;
+		live += work[w].live;
+		free(work[w].pFindings);
+	}
+
+	if (dropped)
+	{
+		streamPuts(ms, "*** WARNING: ");
+		streamUnsigned(ms, dropped);
+		streamPuts(ms, " findings not reported (out of memory).\n");
+	}
+
+	// Release the remaining memory in bulk, unless blocks are still live.
+	if (live)
+		return;
+#ifdef MEMTRACK_ARENA
+	arenaDestroy();
+#endif
+	storeDestroy();
+}
+
+#endif
@@ -0,0 +1,48 @@
+/*************************************************************************
+* Title: memTracker
+* File: memVerify.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the exit verification of memTracker. The block
+* records are split across a pool of worker threads, each checking and
+* releasing the free'd blocks of its share and sorting what it found.
+* The sorted findings are then merged into one report, ordered by
+* allocation site then address.
+*
+* Notes:
+*  (1) Must be called with the tracker lock held, the workers only read
+*      the block records.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Added MEMTRACK_EXIT_FORCE. JME
+*************************************************************************/
+#ifndef _MEM_VERIFY_H_
+#define _MEM_VERIFY_H_
+
+#include "memTrack.h"
+#include "memStream.h"
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Most worker threads used at exit (0 checks on the exiting thread).
+#ifndef MEMTRACK_EXIT_THREADS
+#define MEMTRACK_EXIT_THREADS 8
+#endif
+
+// Define MEMTRACK_EXIT_FORCE to use up to MEMTRACK_EXIT_THREADS workers
+// whatever the number of processors, so tests run the merge anywhere.
+
+// Fewest records given to a worker, smaller heaps use fewer workers.
+#ifndef MEMTRACK_EXIT_MIN_RECORDS
+#define MEMTRACK_EXIT_MIN_RECORDS 16384
+#endif
+
+void verifyBlocks(memstream *);
+
+#endif
+
+#endif
@@ -0,0 +1,218 @@
+/*************************************************************************
+* Title: memTracker.
+* File: memWatch.c
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file implements the watermarks and heap captures. A capture is a
+* copy of the live bytes and blocks of every site, taken under the lock
+* at the moment a watermark is crossed. Only one capture is held at a
+* time: it is written out by the reporter thread, sorted by live bytes,
+* and captures triggered while it is pending are counted but not taken.
+* The count is reported with the next capture written, then cleared.
+*
+* Notes:
+*  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
+*      language options, and with gcc/clang on POSIX systems.
+*  (2) Only compiled at the sampled and full tracking levels.
+*  (3) Released into the public domain.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Captures note estimated site counts at the sampled level. JME
+*   10/19/2026: Added watermarkBytes(). JME
+*   10/19/2026: Skipped count cleared once reported, added watermarkWait(). JME
+*************************************************************************/
+#include "memWatch.h"
+#include "memPlatform.h"
+#include "memStream.h"
+
+// Only compiled at the sampled and full tracking levels.
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Capture states, the reporter only reads a ready capture.
+#define CAPTURE_EMPTY   0
+#define CAPTURE_FILLING 1
+#define CAPTURE_READY   2
+
+size_t watermarkTrigger = SIZE_MAX;
+size_t watermarkRearm = 0;
+
+// Watermarks (0 if none).
+static size_t totalWatermark = 0;
+static size_t siteWatermark = 0;
+
+// The capture.
+static volatile uint64_t captureState = CAPTURE_EMPTY;
+static sitesnapshot captureSites[MEMTRACK_MAX_SITES];
+static uint32_t captureCount = 0;
+static uint32_t captureReason;               // Site which crossed its watermark, or WATERMARK_TOTAL.
+static size_t captureWatermark;              // Watermark crossed.
+static size_t captureTotal;                  // Total tracked memory.
+static volatile uint64_t captureSkipped = 0; // Captures not taken while one was pending.
+
+// Posted as each capture is written, created with the first watermark.
+static memsemaphore captureWritten;
+static bool captureWrittenReady = false;
+
+// Create the semaphore posted as captures are written, once.
+static void watermarkCreate(void)
+{
+	if (!captureWrittenReady)
+		captureWrittenReady = semaphoreCreate(&captureWritten);
+}
+
+// Set the total memory which triggers a capture (0 for none).
+void watermarkSet(size_t bytes)
+{
+	watermarkCreate();
+	totalWatermark = bytes;
+	watermarkArm();
+}
+
+// Set the live bytes of a site which trigger a capture (0 for none).
+void watermarkSetSite(size_t bytes)
+{
+	watermarkCreate();
+	siteWatermark = bytes;
+	siteSetWatermark(bytes);
+}
+
+// Arm the total watermark.
+void watermarkArm(void)
+{
+	watermarkTrigger = totalWatermark ? totalWatermark : SIZE_MAX;
+	watermarkRearm = 0;
+}
+
+// A watermark was crossed, take a capture unless one is pending. Returns
+// true if taken, the reporter should then be woken.
+bool watermarkCapture(size_t total, uint32_t reason)
+{
+	// Disarmed until memory falls back below the hysteresis.
+	if (reason == WATERMARK_TOTAL)
+	{
+		watermarkTrigger = SIZE_MAX;
+		watermarkRearm = WATERMARK_REARM(totalWatermark);
+	}
+
+	if (!atomicCompareSwap(&captureState, CAPTURE_EMPTY, CAPTURE_FILLING))
+	{
+		atomicAdd(&captureSkipped, 1);
+		return false;
+	}
+
+	captureCount = siteSnapshot(captureSites);
+	captureReason = reason;
+	captureWatermark = (reason == WATERMARK_TOTAL) ? totalWatermark : siteWatermark;
+	captureTotal = total;
+
+	atomicCompareSwap(&captureState, CAPTURE_FILLING, CAPTURE_READY);
+
+	return true;
+}
+
+// Return bytes held by the capture.
+size_t watermarkBytes(void)
+{
+	return sizeof(captureSites);
+}
+
+// Order snapshot by live bytes, largest first.
+static int compareLive(const void *a, const void *b)
+{
+	uint64_t pa = ((const sitesnapshot *)a)->liveBytes;
+	uint64_t pb = ((const sitesnapshot *)b)->liveBytes;
+
+	return (pa < pb) - (pa > pb);
+}
+
+// Append site location.
+static void streamLocation(memstream *ms, const sitesnapshot *ps)
+{
+	streamPuts(ms, ps->file);
+	streamPuts(ms, ":");
+	streamUnsigned(ms, (uint64_t)ps->line);
+}
+
+// Write out a ready capture. Returns false if there was none.
+bool watermarkStream(int fd)
+{
+	memstream ms;
+	const sitesnapshot *pReason = NULL;
+	uint64_t skipped;
+
+	if (atomicLoad(&captureState) != CAPTURE_READY)
+		return false;
+
+	// Find the site which crossed its watermark.
+	for (uint32_t i = 0; i < captureCount && captureReason != WATERMARK_TOTAL; i++)
+		if (captureSites[i].site == captureReason)
+			pReason = &captureSites[i];
+
+	streamOpen(&ms, fd);
+	streamPuts(&ms, "\n*** memTracker: heap capture, ");
+	if (pReason != NULL)
+	{
+		streamLocation(&ms, pReason);
+		streamPuts(&ms, " live ");
+		streamUnsigned(&ms, pReason->liveBytes);
+	}
+	else
+	{
+		streamPuts(&ms, "total ");
+		streamUnsigned(&ms, captureTotal);
+	}
+	streamPuts(&ms, " bytes above watermark ");
+	streamUnsigned(&ms, captureWatermark);
+	streamPuts(&ms, " bytes.\nTotal: ");
+	streamUnsigned(&ms, captureTotal);
+	streamPuts(&ms, " bytes");
+	if ((skipped = atomicLoad(&captureSkipped)) != 0)
+	{
+		streamPuts(&ms, " (");
+		streamUnsigned(&ms, skipped);
+		streamPuts(&ms, " captures skipped)");
+
+		// Only those reported, more may be skipped meanwhile.
+		atomicAdd(&captureSkipped, (uint64_t)0 - skipped);
+	}
+#if MEMTRACK_LEVEL == MEMTRACK_SAMPLED
+	streamPuts(&ms, "\nLive memory by site (estimated from 1 in ");
+	streamUnsigned(&ms, MEMTRACK_SAMPLE_RATE);
+	streamPuts(&ms, " blocks):\n");
+#else
+	streamPuts(&ms, "\nLive memory by site:\n");
+#endif
+
+	qsort(captureSites, captureCount, sizeof(sitesnapshot), compareLive);
+	for (uint32_t i = 0; i < captureCount; i++)
+	{
+		streamLocation(&ms, &captureSites[i]);
+		streamPuts(&ms, " live: ");
+		streamUnsigned(&ms, captureSites[i].liveBytes);
+		streamPuts(&ms, " bytes in ");
+		streamUnsigned(&ms, captureSites[i].liveBlocks);
+		streamPuts(&ms, " blocks\n");
+	}
+	streamFlush(&ms);
+
+	atomicCompareSwap(&captureState, CAPTURE_READY, CAPTURE_EMPTY);
+	if (captureWrittenReady)
+		semaphorePost(&captureWritten);
+
+	return true;
+}
+
+// Wait up to ns for a pending capture to be written. Returns false if
+// one is still pending.
+bool watermarkWait(uint64_t ns)
+{
+	while (atomicLoad(&captureState) != CAPTURE_EMPTY)
+		if (!captureWrittenReady || !semaphoreWaitFor(&captureWritten, ns))
+			return false;
+
+	return true;
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*************************************************************************
+* Title: memTracker
+* File: memWatch.h
+* Author: James Eli
+* Date: 10/19/2026
+*
+* This file declares the watermarks of memTracker. When total live
+* memory, or the live memory of one site, rises above its watermark a
+* snapshot of live memory per site is taken and handed to the reporter
+* thread to write out (written at once if there is no reporter). The
+* watermark is then disarmed until memory falls
+* MEMTRACK_WATERMARK_HYSTERESIS percent below it (see memProfile.h).
+*
+* Notes:
+*  (1) All functions, except watermarkStream() and watermarkWait(), must
+*      be called with the tracker lock held. watermarkStream() is called
+*      by the reporter, watermarkWait() without the lock.
+*  (2) Below its watermarks an allocation costs a single compare of the
+*      total against watermarkTrigger. At the sampled level the total is
+*      the live bytes of all blocks (see threadLiveEstimate()), and site
+*      live bytes are compared against the site watermark divided by the
+*      sample rate.
+*  (3) Only compiled at the sampled and full tracking levels.
+*  (4) Internal header, do not include in your project files.
+*************************************************************************
+* Change Log:
+*   10/19/2026: Initial release. JME
+*   10/19/2026: Sampled level compares all live bytes. JME
+*   10/19/2026: Added watermarkBytes(). JME
+*   10/19/2026: Added watermarkWait(). JME
+*************************************************************************/
+#ifndef _MEM_WATCH_H_
+#define _MEM_WATCH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "memTrack.h"
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+#include "memProfile.h"
+
+// Capture triggered by total memory rather than a site.
+#define WATERMARK_TOTAL UINT32_MAX
+
+extern size_t watermarkTrigger; // Capture above this total (SIZE_MAX if none or crossed).
+extern size_t watermarkRearm;   // Re-arm below this total (0 unless crossed).
+
+void watermarkSet(size_t);
+void watermarkSetSite(size_t);
+bool watermarkCapture(size_t, uint32_t);
+void watermarkArm(void);
+bool watermarkStream(int);
+bool watermarkWait(uint64_t);
+size_t watermarkBytes(void);
+
+#endif
+
+#endif
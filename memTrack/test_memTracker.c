@@ -20,22 +20,58 @@
 *    exit(). This demonstrates the warning associated with a memory 
 *    leak.
 *
+* Before the demonstration, the tracking functions are checked. A failed
+* check is printed, and the program then exits with EXIT_FAILURE.
+*
 * Notes:
 *  (1) Compiled with MS Visual Studio 2017 Community (v141), using C
 *      language options.
-*  (2) Only compiles in the Debug version of project.
-*  (3) Released into the public domain.
+*  (2) Only compiles in the Debug and Debug Arena versions of project,
+*      the latter with MEMTRACK_ARENA.
+*  (3) Below the full tracking level blocks are released at once, so the
+*      memory errors of steps 2, 4 and 5 are only made at the full level.
+*  (4) The exit report is checked too, and at the full level its
+*      findings. Build with MEMTRACK_EXIT_FORCE so they are merged from
+*      several workers on any number of processors.
+*  (5) Released into the public domain.
 *************************************************************************
 * Change Log:
 *   11/13/2017: Initial release. JME
 *   11/18/2017: Added calloc, realloc and reporting functionality. JME
+*   10/19/2026: Memory errors only made at the full tracking level. JME
+*   10/19/2026: Added checks of validateSpans(). JME
+*   10/19/2026: Added checks of watermarks. JME
+*   10/19/2026: Added checks of getMemoryOverhead(). JME
+*   10/19/2026: Added checks of getAllocationCounters(). JME
+*   10/19/2026: Added checks of the record store's overflow table. JME
+*   10/19/2026: Heap captures waited for through the reporter. JME
+*   10/19/2026: Added checks of the exit report. JME
+*   10/19/2026: Built with MEMTRACK_ARENA in the Debug Arena configuration. JME
+*   10/19/2026: Added checks of signalled reports and the abort handler. JME
+*   10/19/2026: Added checks of the site profile and timeline. JME
+*   10/19/2026: Added checks of cross-thread frees. JME
 *************************************************************************/
+// fileno() and sigsetjmp() are POSIX rather than ISO C.
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <setjmp.h>
+#include <time.h>
 
 // Add debug memory allocation routines.
 #include "memTracker.h"
 
+// Internal record store, watermarks and threads, for the checks of its
+// overflow table, to wait for heap captures and to free from a thread.
+#include "memStore.h"
+#include "memWatch.h"
+#include "memPlatform.h"
+
 #ifdef _MSC_VER
 // C/C++ Preprocessor Definitions: _CRT_SECURE_NO_WARNINGS
 #pragma warning(disable:4996) 
@@ -48,6 +84,649 @@ struct test {
 	double d;
 };
 
+// Number of failed checks.
+static int failures = 0;
+
+// Print a failed check.
+#define CHECK(cond) \
+	if (!(cond)) \
+	{ \
+		fprintf(stderr, "*** CHECK FAILED: %s, line #%d\n", #cond, __LINE__); \
+		failures++; \
+	}
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// File receiving the per-thread counters.
+#define THREAD_FILE "memTracker_threads.txt"
+
+// Block handed to the second thread, and the block it hands back.
+typedef struct CROSSTHREAD {
+	char *pMain;        // Allocated by the main thread, free'd by the second.
+	char *pWorker;      // Allocated by the second thread.
+	uint64_t id;        // Identifier of the second thread.
+	memsemaphore done;  // Posted when the second thread has finished.
+} crossthread;
+
+// Second thread, frees the main thread's block and allocates one.
+static void crossThread(void *arg)
+{
+	crossthread *pct = (crossthread *)arg;
+
+	pct->id = threadIdentifier();
+	free(pct->pMain);
+	pct->pWorker = (char *)malloc(3000);
+	semaphorePost(&pct->done);
+}
+
+// Each thread's counters, and the cross-thread matrix, follow blocks
+// free'd by a thread other than their allocating one.
+static void testCrossThread(void)
+{
+	static char text[16384];
+	FILE *pf = fopen(THREAD_FILE, "w+");
+	memcounters before, after;
+	crossthread ct;
+	char line[128];
+	size_t length;
+	int slot = -1;
+
+	CHECK(pf != NULL);
+	if (pf == NULL)
+		return;
+	CHECK(semaphoreCreate(&ct.done));
+
+	getAllocationCounters(&before);
+	ct.pMain = (char *)malloc(5000);
+	CHECK(threadStart(crossThread, &ct));
+	semaphoreWait(&ct.done);
+	semaphoreDestroy(&ct.done);
+	free(ct.pWorker);
+	getAllocationCounters(&after);
+	CHECK(after.allocations == before.allocations + 2 && after.frees == before.frees + 2);
+	CHECK(after.liveBytes == before.liveBytes);
+
+	reportAllocationsTo(fileno(pf));
+	rewind(pf);
+	length = fread(text, 1, sizeof(text) - 1, pf);
+	fclose(pf);
+	remove(THREAD_FILE);
+	text[length] = '\0';
+
+	// The second thread's slot, which made one allocation and one free
+	// and owns no live bytes.
+	snprintf(line, sizeof(line), " (id %llu) allocs: 1 frees: 1 live: 0 bytes\n", (unsigned long long)ct.id);
+	for (char *p = strstr(text, line); p != NULL && p > text && slot < 0; p--)
+		if (*p == '#')
+			slot = atoi(p + 1);
+	CHECK(slot > 0);
+
+	// Each block counted against its allocating thread. The main thread
+	// made the first allocation, so has slot #0.
+	snprintf(line, sizeof(line), "\n#%d <- #0 frees: 1 bytes: 5000\n", slot);
+	CHECK(strstr(text, line) != NULL);
+	snprintf(line, sizeof(line), "\n#0 <- #%d frees: 1 bytes: 3000\n", slot);
+	CHECK(strstr(text, line) != NULL);
+}
+
+// The counters follow a block as it is allocated, resized and free'd, at
+// every level. A resize is neither an allocation nor a free.
+static void testCounters(void)
+{
+	memcounters before, after;
+	char *p;
+
+	getAllocationCounters(&before);
+	p = (char *)malloc(5000);
+	getAllocationCounters(&after);
+	CHECK(after.allocations == before.allocations + 1);
+	CHECK(after.liveBytes == before.liveBytes + 5000);
+	CHECK(after.peakBytes >= after.liveBytes);
+
+	p = (char *)realloc(p, 8000);
+	getAllocationCounters(&after);
+	CHECK(after.allocations == before.allocations + 1 && after.frees == before.frees);
+	CHECK(after.liveBytes == before.liveBytes + 8000);
+
+	free(p);
+	getAllocationCounters(&after);
+	CHECK(after.frees == before.frees + 1);
+	CHECK(after.liveBytes == before.liveBytes);
+	CHECK(after.peakBytes >= before.liveBytes + 8000);
+
+	testCrossThread();
+}
+
+#ifdef SIGUSR1
+
+// File receiving the signalled reports.
+#define SIGNAL_FILE "memTracker_signal.txt"
+
+// Longest wait for the reporter to write a report (ms).
+#define REPORT_WAIT 5000
+
+// Return to testSignals() from the program's abort handler.
+static sigjmp_buf abortJump;
+static volatile sig_atomic_t abortExpected = 0;
+static volatile sig_atomic_t abortChained = 0;
+
+// The program's own abort handler. Installed before the first allocation,
+// so the tracker installs its handler over it, and chains to it.
+static void programAbortHandler(int sig)
+{
+	abortChained = 1;
+	if (abortExpected)
+		siglongjmp(abortJump, 1);
+
+	signal(sig, SIG_DFL);
+	raise(sig);
+}
+
+// SIGUSR1 has the reporter thread write a report. SIGABRT has the
+// tracker list live allocations, then put back and raise the program's
+// handler.
+static void testSignals(void)
+{
+	static char text[65536];
+	FILE *pf = fopen(SIGNAL_FILE, "w+");
+	char *pAbort, *p;
+	size_t length;
+
+	CHECK(pf != NULL);
+	if (pf == NULL)
+		return;
+	setReportDescriptor(fileno(pf));
+
+	p = (char *)malloc(100);
+	raise(SIGUSR1);
+	CHECK(waitForReport(REPORT_WAIT));
+
+	abortExpected = 1;
+	if (sigsetjmp(abortJump, 1) == 0)
+		raise(SIGABRT);
+	abortExpected = 0;
+	signal(SIGABRT, SIG_DFL);
+	CHECK(abortChained);
+	free(p);
+
+	setReportDescriptor(fileno(stderr));
+	rewind(pf);
+	length = fread(text, 1, sizeof(text) - 1, pf);
+	fclose(pf);
+	remove(SIGNAL_FILE);
+	text[length] = '\0';
+
+	// The signalled report, then the abort listing.
+	pAbort = strstr(text, "\n*** memTracker: abort.\n");
+	CHECK(pAbort != NULL);
+	if (pAbort == NULL)
+		return;
+	*pAbort++ = '\0';
+	CHECK(strstr(text, "Allocations: ") != NULL);
+	CHECK(strstr(pAbort, "Allocations: ") != NULL);
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+	CHECK(strstr(text, "\nTimeline:\n") != NULL);
+#endif
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	// The block is listed by both.
+	CHECK(strstr(text, " size: 100 [ malloc ]\n") != NULL);
+	CHECK(strstr(pAbort, " size: 100 [ malloc ]\n") != NULL);
+#endif
+}
+
+#endif
+
+#endif
+
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+
+// Blocks allocated around the spans, so a few spans are checked by one
+// walk of the records and many through the sorted view.
+#define SPAN_POOL 256
+
+// Check validateSpans() against the expected status of each span. Only
+// invalid spans are known at the sampled level, others may be untracked.
+static void checkSpans(const memspan *pSpans, const unsigned char *expected, size_t count)
+{
+	memspanerror errors[16];
+	uint8_t bitmap[2];
+	size_t invalid = 0, found;
+
+	for (size_t i = 0; i < count; i++)
+		if (expected[i] != SPAN_VALID)
+			invalid++;
+
+	found = validateSpans(pSpans, count, bitmap, errors, 16);
+
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	CHECK(found == invalid);
+	for (size_t i = 0; i < count; i++)
+		CHECK(((bitmap[i / 8] >> (i % 8)) & 1) == (expected[i] != SPAN_VALID));
+	for (size_t e = 0; e < found && e < 16; e++)
+		CHECK(errors[e].span < count && errors[e].status == expected[errors[e].span]);
+#else
+	for (size_t i = 0; i < count; i++)
+		if (expected[i] == SPAN_INVALID)
+			CHECK((bitmap[i / 8] >> (i % 8)) & 1);
+	(void)invalid;
+	(void)found;
+#endif
+}
+
+// Spans within, across and just past a block, in free'd and untracked
+// memory, and NULL or empty.
+static void testSpans(void)
+{
+	char *pool[SPAN_POOL];
+	memspan all[SPAN_POOL];
+	char *pBlock, *pFreed;
+	int local = 0;
+
+	for (int i = 0; i < SPAN_POOL; i++)
+		pool[i] = (char *)malloc(32);
+	pBlock = (char *)malloc(100);
+	pFreed = (char *)malloc(100);
+	free(pFreed);
+
+	const memspan spans[] = {
+		{ pBlock, 100 },              // Whole block.
+		{ pBlock + 99, 1 },           // Last byte.
+		{ pBlock + 50, 51 },          // Runs one byte past the end.
+		{ pBlock, 101 },
+		{ pBlock + 100, 1 },          // Starts past the end.
+		{ NULL, 4 },
+		{ pBlock, 0 },
+		{ pFreed + 10, 1 },
+		{ &local, sizeof(local) },
+	};
+	const unsigned char expected[] = {
+		SPAN_VALID, SPAN_VALID, SPAN_OVERRUN, SPAN_OVERRUN, SPAN_UNKNOWN,
+		SPAN_INVALID, SPAN_INVALID, SPAN_FREED, SPAN_UNKNOWN,
+	};
+	const size_t count = sizeof(spans) / sizeof(memspan);
+
+	// New blocks leave the sorted view stale, so few spans walk the records.
+	checkSpans(spans, expected, count);
+
+	// Many spans sort the view, which is then kept for the next few.
+	for (int i = 0; i < SPAN_POOL; i++)
+	{
+		all[i].pMem = pool[i];
+		all[i].size = 32;
+	}
+	CHECK(validateSpans(all, SPAN_POOL, NULL, NULL, 0) == 0);
+	checkSpans(spans, expected, count);
+
+	for (int i = 0; i < SPAN_POOL; i++)
+		free(pool[i]);
+	free(pBlock);
+}
+
+// File receiving the heap captures.
+#define CAPTURE_FILE "memTracker_capture.txt"
+
+// Count heap captures with heading written so far.
+static int countCaptures(const char *heading)
+{
+	static char text[65536];
+	FILE *pf = fopen(CAPTURE_FILE, "r");
+	size_t length;
+	int count = 0;
+
+	if (pf == NULL)
+		return 0;
+	length = fread(text, 1, sizeof(text) - 1, pf);
+	fclose(pf);
+	text[length] = '\0';
+
+	for (char *p = strstr(text, heading); p != NULL; p = strstr(p + 1, heading))
+		count++;
+
+	return count;
+}
+
+// Longest wait for the reporter to write a capture (ns).
+#define CAPTURE_WAIT 5000000000ull
+
+// Wait for the reporter to write any pending capture, then count the
+// captures with heading.
+static int waitCaptures(const char *heading)
+{
+	CHECK(watermarkWait(CAPTURE_WAIT));
+
+	return countCaptures(heading);
+}
+
+// Watermarks are compared as tracked blocks are allocated and free'd, at
+// the sampled level only 1 in MEMTRACK_SAMPLE_RATE (at most 2 * rate - 1
+// apart), so churn enough small blocks for some to be tracked.
+static void churnBlocks(void)
+{
+	for (int i = 0; i < 4 * MEMTRACK_SAMPLE_RATE; i++)
+		free(malloc(1));
+}
+
+// Total and site watermarks capture the heap once when crossed, and again
+// only after memory fell back MEMTRACK_WATERMARK_HYSTERESIS (10) percent.
+static void testWatermarks(void)
+{
+	const char *total = "heap capture, total";
+	const char *site = "heap capture, " __FILE__ ":";
+	FILE *pf = fopen(CAPTURE_FILE, "w");
+	memcounters counters;
+	char *pool[4096];
+	char *pBig, *pSmall, *pTiny;
+
+	CHECK(pf != NULL);
+	if (pf == NULL)
+		return;
+	setReportDescriptor(fileno(pf));
+
+	// Crossed once.
+	getAllocationCounters(&counters);
+	setWatermark((size_t)counters.liveBytes + 100000);
+	pBig = (char *)malloc(60000);
+	pSmall = (char *)malloc(60000);
+	churnBlocks();
+	CHECK(waitCaptures(total) == 1);
+
+	// Not re-armed while within the hysteresis.
+	pTiny = (char *)malloc(5000);
+	free(pTiny);
+	pTiny = (char *)malloc(5000);
+	churnBlocks();
+	CHECK(waitCaptures(total) == 1);
+
+	// Re-armed below it.
+	free(pSmall);
+	churnBlocks();
+	pSmall = (char *)malloc(60000);
+	churnBlocks();
+	CHECK(waitCaptures(total) == 2);
+
+	setWatermark(0);
+	free(pTiny);
+	free(pSmall);
+	free(pBig);
+
+	// A site crossing, and again after all its blocks were free'd.
+	setSiteWatermark(128 * 1024);
+	for (int pass = 1; pass <= 2; pass++)
+	{
+		for (int i = 0; i < 4096; i++)
+			pool[i] = (char *)malloc(64);
+		CHECK(waitCaptures(site) == pass);
+		for (int i = 0; i < 4096; i++)
+			free(pool[i]);
+	}
+	setSiteWatermark(0);
+	CHECK(countCaptures(total) == 2);
+
+	setReportDescriptor(fileno(stderr));
+	fclose(pf);
+	remove(CAPTURE_FILE);
+}
+
+// The overhead follows a block as it is allocated, resized and free'd.
+// Untracked blocks are not counted, so only checked at the full level.
+static void testOverhead(void)
+{
+	memoverhead before;
+
+	getMemoryOverhead(&before);
+	CHECK(before.metadataBytes > 0);
+
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	memoverhead after;
+	char *p = (char *)malloc(1000);
+
+	getMemoryOverhead(&after);
+	CHECK(after.userBytes == before.userBytes + 1000);
+	CHECK(after.canaryBytes > before.canaryBytes);
+	CHECK(after.metadataBytes > before.metadataBytes);
+
+	p = (char *)realloc(p, 3000);
+	getMemoryOverhead(&after);
+	CHECK(after.userBytes == before.userBytes + 3000);
+
+	free(p);
+	getMemoryOverhead(&after);
+	CHECK(after.userBytes == before.userBytes);
+	CHECK(after.canaryBytes == before.canaryBytes);
+#ifndef MEMTRACK_ARENA
+	// Free'd system blocks are held until exit. Arena quarantine also
+	// releases older slots, so may not grow.
+	CHECK(after.quarantineBytes >= before.quarantineBytes + 3000);
+#endif
+#endif
+}
+
+// File receiving the profile.
+#define PROFILE_FILE "memTracker_profile.txt"
+
+// Blocks allocated from the profiled site, and their size.
+#define PROFILE_BLOCKS 200
+#define PROFILE_SIZE   32
+
+// Spin for ms of processor time, while the reporter samples the timeline.
+static void spin(unsigned int ms)
+{
+	clock_t start = clock();
+
+	while ((unsigned long long)(clock() - start) * 1000 < (unsigned long long)ms * CLOCKS_PER_SEC)
+		;
+}
+
+// A site lists its allocations, live blocks and bytes, and the lifetime
+// of each free. The timeline samples total memory every interval, in
+// time order.
+static void testProfile(void)
+{
+	static char text[65536];
+	FILE *pf = fopen(PROFILE_FILE, "w+");
+	char *pool[PROFILE_BLOCKS];
+	unsigned long long ms, lastMs = 0, total = 0;
+	size_t length;
+	int samples = 0, n;
+	char *p;
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	unsigned long long lifetimes = 0, count;
+	char counts[128];
+#endif
+
+	CHECK(pf != NULL);
+	if (pf == NULL)
+		return;
+
+	setTimelineInterval(1);
+	for (int i = 0; i < PROFILE_BLOCKS; i++)
+		pool[i] = (char *)malloc(PROFILE_SIZE);
+	for (int i = 0; i < PROFILE_BLOCKS; i += 2)
+		free(pool[i]);
+	spin(20);
+	reportProfileTo(fileno(pf));
+	setTimelineInterval(MEMTRACK_TIMELINE_INTERVAL_MS);
+	for (int i = 1; i < PROFILE_BLOCKS; i += 2)
+		free(pool[i]);
+
+	rewind(pf);
+	length = fread(text, 1, sizeof(text) - 1, pf);
+	fclose(pf);
+	remove(PROFILE_FILE);
+	text[length] = '\0';
+
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	// The pool's site, half its blocks still live.
+	snprintf(counts, sizeof(counts), " allocs: %d live: %d bytes: %d rate: ", PROFILE_BLOCKS, PROFILE_BLOCKS / 2, PROFILE_BLOCKS * PROFILE_SIZE);
+	p = strstr(text, counts);
+	CHECK(p != NULL);
+	if (p == NULL)
+		return;
+	while (p > text && p[-1] != '\n')
+		p--;
+	CHECK(strncmp(p, __FILE__ ":", strlen(__FILE__ ":")) == 0);
+
+	// One lifetime for each free.
+	p = strstr(p, "ns [");
+	CHECK(p != NULL);
+	if (p == NULL)
+		return;
+	for (p += 4; strncmp(p, " ]", 2) != 0 && sscanf(p, " %*[^: ]:%llu%n", &count, &n) == 1; p += n)
+		lifetimes += count;
+	CHECK(lifetimes == PROFILE_BLOCKS / 2);
+#else
+	CHECK(strstr(text, "\nAllocation sites (1 in ") != NULL);
+#endif
+
+	// Samples in time order, the last taken while the pool was live.
+	p = strstr(text, "\nTimeline:\n");
+	CHECK(p != NULL);
+	if (p == NULL)
+		return;
+	for (p += strlen("\nTimeline:\n"); sscanf(p, "+%llums total: %llu\n%n", &ms, &total, &n) == 2; p += n)
+	{
+		CHECK(ms >= lastMs);
+		lastMs = ms;
+		samples++;
+	}
+	CHECK(samples >= 2);
+	CHECK(total >= PROFILE_BLOCKS / 2 * PROFILE_SIZE);
+}
+
+#if SIZE_MAX > UINT32_MAX
+
+// Sizes of 4 GB and more are kept in the store's overflow table. Blocks
+// that large would be painted in full, so the store is driven directly.
+// The tracker calls it with the lock held, here no other thread allocates.
+static void testOverflowSizes(void)
+{
+	static uint8_t fake[2];
+	const size_t big = (size_t)5 << 30;
+	uint32_t a, b;
+
+	a = storeCreate(&fake[0], big, TAG_MAKE(BLOCK_STATUS_MALLOC, 0, 0), 0);
+	b = storeCreate(&fake[1], big + 1, TAG_MAKE(BLOCK_STATUS_MALLOC, 0, 0), 0);
+	CHECK(a != BLOCK_NONE && b != BLOCK_NONE);
+	if (a == BLOCK_NONE || b == BLOCK_NONE)
+		return;
+	CHECK(storeSize(a) == big && storeSize(b) == big + 1);
+
+	// Out of the table, back in, and resized within it.
+	storeSetSize(a, 100);
+	CHECK(storeSize(a) == 100 && storeSize(b) == big + 1);
+	storeSetSize(a, big * 2);
+	storeSetSize(b, (size_t)UINT32_MAX);
+	CHECK(storeSize(a) == big * 2 && storeSize(b) == UINT32_MAX);
+
+	// Releasing one record keeps the other's entry.
+	storeRelease(a);
+	CHECK(storeSize(b) == UINT32_MAX);
+	storeRelease(b);
+}
+
+#endif
+
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+
+// Blocks allocated for the exit check, over two workers' shares of the
+// records (MEMTRACK_EXIT_MIN_RECORDS), alternately from two sites. Two of
+// every EXIT_LEAK_STRIDE are not free'd, so both sites leak in each share.
+#define EXIT_BLOCKS      40000
+#define EXIT_LEAK_STRIDE 4000
+
+// Blocks not free'd by exitBlocks().
+static int exitLeaks = 0;
+
+// Allocate the blocks for the exit check.
+static void exitBlocks(void)
+{
+	for (int i = 0; i < EXIT_BLOCKS; i++)
+	{
+		char *p;
+
+		if (i & 1)
+			p = (char *)malloc(8);
+		else
+			p = (char *)malloc(16);
+
+		if (i % EXIT_LEAK_STRIDE < 2)
+			exitLeaks++;
+		else
+			free(p);
+	}
+}
+
+#endif
+
+#endif
+
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+
+// File receiving the exit report.
+#define EXIT_FILE "memTracker_exit.txt"
+
+// Check the exit report, then copy it to stderr. Registered before the
+// tracker's atexit() handler, so runs after it. The counters must be
+// written, and findings of a site listed together and in address order,
+// however the records were split among the workers.
+static void checkExitReport(void)
+{
+	static const char notFreed[] = "*** WARNING: Memory not free'd at ";
+	static char line[512], site[128], lastSite[128];
+	static char sitesDone[64][128];
+	FILE *pf = fopen(EXIT_FILE, "r");
+	unsigned long long address, lastAddress = 0;
+	int done = 0, leaks = 0, ordered = 1, counted = 0;
+
+	if (pf == NULL)
+	{
+		fprintf(stderr, "*** CHECK FAILED: exit report not written\n");
+		_Exit(EXIT_FAILURE);
+	}
+
+	lastSite[0] = '\0';
+	while (fgets(line, sizeof(line), pf) != NULL)
+	{
+		fputs(line, stderr);
+
+		if (strncmp(line, "Allocations: ", 13) == 0)
+			counted = 1;
+		if (sscanf(line, "*** WARNING: %*[^0]%llx (%*u bytes, %127[^)])", &address, site) != 2)
+			continue;
+		if (strncmp(line, notFreed, sizeof(notFreed) - 1) == 0 && strstr(site, __FILE__) != NULL)
+			leaks++;
+
+		if (strcmp(site, lastSite) == 0)
+		{
+			ordered &= (address > lastAddress);
+		}
+		else
+		{
+			// A new site, which must not have been listed before.
+			for (int i = 0; i < done; i++)
+				ordered &= (strcmp(sitesDone[i], site) != 0);
+			if (lastSite[0] != '\0' && done < 64)
+				strcpy(sitesDone[done++], lastSite);
+			strcpy(lastSite, site);
+		}
+		lastAddress = address;
+	}
+	fclose(pf);
+	remove(EXIT_FILE);
+
+	CHECK(counted);
+	CHECK(ordered);
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	// exitBlocks()' leaks, and one of the demonstration.
+	CHECK(leaks == exitLeaks + 1);
+#endif
+	fflush(stderr);
+	if (failures)
+		_Exit(EXIT_FAILURE);
+}
+
+#endif
+
 int main(void) {
 	// Pointers used for testing memory allocation.
 	struct test *pStruct;
@@ -57,6 +736,27 @@ int main(void) {
 	// Redirect staderr output to a file.
 	//freopen("memTracker.txt", "w", stderr);
 
+	// Check the tracking functions before the errors below.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+	atexit(checkExitReport);
+#ifdef SIGUSR1
+	signal(SIGABRT, programAbortHandler);
+#endif
+	testCounters();
+#ifdef SIGUSR1
+	testSignals();
+#endif
+#endif
+#if MEMTRACK_LEVEL >= MEMTRACK_SAMPLED
+	testSpans();
+	testWatermarks();
+	testOverhead();
+	testProfile();
+#if SIZE_MAX > UINT32_MAX
+	testOverflowSizes();
+#endif
+#endif
+
 	// Allocate memory via calling malloc().
 	pChar[0] = (char *)malloc(sizeof(char));
 	pChar[1] = (char *)malloc(sizeof(char));
@@ -66,18 +766,24 @@ int main(void) {
 	pStruct = (struct test *)malloc(sizeof(struct test));
 
 	*pChar[0] = 'A';        // Fill allocated memory with value.
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
 	*(pChar[1] - 1) = 'X';	// Under-run error.
 	*(pChar[2] + 1) = 'X';	// Over-run error.
+#endif
 
 	unsigned int *p = malloc(sizeof(unsigned int));
 	*p = 0x12345678;
 	unsigned int *np = realloc(p, 2 * sizeof(unsigned int));
 
 	free(pInt);
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
 	*pInt = 0x12345678;	    // Warning for memory access after free().
+#endif
 	free(pStruct);
 	free(pChar[0]);
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
 	free(pChar[0]);         // Previous free'd memory warning. 
+#endif
 	free(pChar[1]);
 	realloc(pChar[2], 0);   // Same as calling free.
 	//free(pChar[3]);       // Warning that all memory not free'd.
@@ -87,5 +793,17 @@ int main(void) {
 	reportAllocations();    // Print status report of all allocations.
 #endif
 
-	exit(EXIT_SUCCESS);     // Program exit calls our allocation check function.
+#if MEMTRACK_LEVEL > MEMTRACK_OFF
+	// Write the exit report to a file for checkExitReport().
+	FILE *pExit = fopen(EXIT_FILE, "w");
+
+	CHECK(pExit != NULL);
+#if MEMTRACK_LEVEL == MEMTRACK_FULL
+	exitBlocks();
+#endif
+	if (pExit != NULL)
+		setReportDescriptor(fileno(pExit));
+#endif
+
+	exit(failures ? EXIT_FAILURE : EXIT_SUCCESS); // Program exit calls our allocation check function.
 }